@@ -0,0 +1,92 @@
+#include "Batch.h"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include "ErrorBuffer.h"
+#include "EmmentalException.h"
+#include "Globals.h"
+#include "Quota.h"
+#include "TopLevel.h"
+#include "Util.h"
+
+// Runs the program against one input, with a private interpreter that starts from the image
+static int RunInput(const ProgramImage& image, const std::string& inputPath, std::ostream& error)
+{
+#if _WIN32 && _UNICODE
+	std::ifstream input(Util::ToUtf16(inputPath), std::ios_base::binary | std::ios_base::in);
+	std::ofstream output(Util::ToUtf16(inputPath + Batch::OutputExtension), std::ios_base::binary | std::ios_base::out);
+#else // _WIN32 && _UNICODE
+	std::ifstream input(inputPath, std::ios_base::binary | std::ios_base::in);
+	std::ofstream output(inputPath + Batch::OutputExtension, std::ios_base::binary | std::ios_base::out);
+#endif // _WIN32 && _UNICODE
+
+	if (!input || !output)
+	{
+		error << "Error: Unable to open the input file, or to create its output file." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Emmental interpreter(input, output, error);
+	image.Restore(interpreter);
+
+	int result = EXIT_SUCCESS;
+
+	try
+	{
+		if (Quota::IsLimited())
+		{
+			if (!Quota::Interpret(interpreter, image.GetRest(), image.GetRestSize()))
+				result = Quota::ExitCode;
+		}
+		else
+			TopLevel::Interpret(interpreter, image.GetRest(), image.GetRestSize());
+	}
+	catch (const EmmentalException&)
+	{
+		result = EXIT_FAILURE;
+	}
+
+	interpreter.SummarizeDiagnostics();
+	return result;
+}
+
+int Batch::Run(const ProgramImage& image, const std::vector<std::string>& inputs, unsigned int workerCount)
+{
+	if (workerCount > inputs.size())
+		workerCount = (unsigned int)inputs.size();
+
+	// Workers take the next input as they finish, so a few long runs don't leave the others idle
+	std::atomic<std::size_t> next(0);
+	std::vector<int> statuses(inputs.size(), EXIT_SUCCESS);
+	std::vector<std::thread> workers;
+	std::mutex errorLock;
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back([&]()
+		{
+			for (std::size_t index = next++; index < inputs.size(); index = next++)
+			{
+				ErrorBuffer errorBuffer(errorLock, inputs[index] + ": ");
+				std::ostream error(&errorBuffer);
+
+				statuses[index] = RunInput(image, inputs[index], error);
+				error.flush();
+			}
+		});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	int status = EXIT_SUCCESS;
+	for (int result : statuses)
+	{
+		if (result != EXIT_SUCCESS)
+			status = result;
+	}
+
+	return status;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "ProgramImage.h"
+
+// Runs a prepared program once per input file, on a pool of worker threads sharing the program image.
+// Each run reads its input file and writes its output to the same path with ".out" appended. Errors go to the standard error, preceded by the input path.
+namespace Batch
+{
+	// Extension appended to an input path to name its output file
+	const char* const OutputExtension = ".out";
+
+	// Runs every input on up to workerCount threads, and returns the last unsuccessful exit status, or EXIT_SUCCESS if all runs succeeded.
+	int Run(const ProgramImage& image, const std::vector<std::string>& inputs, unsigned int workerCount);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "Channel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+Channel::Channel(std::size_t capacity) : ReadCount(0), WriteCount(0), WriterClosed(false), ReaderClosed(false)
+{
+	std::size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+
+	Buffer.resize(size);
+	Mask = size - 1;
+}
+
+bool Channel::Write(const char* data, std::size_t size)
+{
+	unsigned int attempt = 0;
+	std::size_t written = WriteCount.load(std::memory_order_relaxed);
+
+	while (size > 0)
+	{
+		if (ReaderClosed.load(std::memory_order_relaxed))
+			return false;
+
+		std::size_t free = Buffer.size() - (written - ReadCount.load(std::memory_order_acquire));
+		if (free == 0)
+		{
+			Wait(attempt);
+			continue;
+		}
+
+		// Copy as much as fits, in up to two pieces around the end of the buffer
+		std::size_t count = std::min(free, size);
+		std::size_t start = written & Mask;
+		std::size_t first = std::min(count, Buffer.size() - start);
+
+		std::memcpy(&Buffer[start], data, first);
+		std::memcpy(&Buffer[0], data + first, count - first);
+
+		written += count;
+		WriteCount.store(written, std::memory_order_release);
+		data += count;
+		size -= count;
+		attempt = 0;
+	}
+
+	return true;
+}
+
+std::size_t Channel::Read(char* data, std::size_t size)
+{
+	unsigned int attempt = 0;
+	std::size_t read = ReadCount.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		std::size_t available = WriteCount.load(std::memory_order_acquire) - read;
+
+		if (available == 0)
+		{
+			// Bytes written before closing are visible once the close is
+			if (WriterClosed.load(std::memory_order_acquire) && WriteCount.load(std::memory_order_acquire) == read)
+				return 0;
+
+			Wait(attempt);
+			continue;
+		}
+
+		std::size_t count = std::min(available, size);
+		std::size_t start = read & Mask;
+		std::size_t first = std::min(count, Buffer.size() - start);
+
+		std::memcpy(data, &Buffer[start], first);
+		std::memcpy(data + first, &Buffer[0], count - first);
+
+		ReadCount.store(read + count, std::memory_order_release);
+		return count;
+	}
+}
+
+bool Channel::CanRead() const
+{
+	return WriteCount.load(std::memory_order_acquire) != ReadCount.load(std::memory_order_relaxed) || WriterClosed.load(std::memory_order_acquire);
+}
+
+void Channel::CloseWriter() { WriterClosed.store(true, std::memory_order_release); }
+
+void Channel::CloseReader() { ReaderClosed.store(true, std::memory_order_relaxed); }
+
+void Channel::Wait(unsigned int& attempt)
+{
+	// Spin briefly for the other end, then give up the CPU, then sleep so an idle stage costs nothing
+	if (attempt >= 128)
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	else if (attempt >= 64)
+		std::this_thread::yield();
+
+	attempt++;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded byte queue between one writer thread and one reader thread, without locks.
+// Both ends transfer bytes in batches, and wait with a backoff while the queue is full or empty.
+class Channel
+{
+public:
+	// The capacity is rounded up to a power of two
+	explicit Channel(std::size_t capacity);
+
+	// Writes all bytes, waiting while the channel is full. Returns false once the reader closed the channel, dropping the bytes not written yet.
+	bool Write(const char* data, std::size_t size);
+	// Reads between 1 and size bytes, waiting while the channel is empty. Returns 0 once the writer closed the channel and every byte was read.
+	std::size_t Read(char* data, std::size_t size);
+
+	// Checks if a Read() would return without waiting
+	bool CanRead() const;
+
+	void CloseWriter();
+	void CloseReader();
+
+private:
+	std::vector<char> Buffer;
+	std::size_t Mask;
+
+	// Total bytes read and written, each only changed by its own end. Padding keeps them on separate cache lines.
+	std::atomic<std::size_t> ReadCount;
+	char ReadPadding[64];
+	std::atomic<std::size_t> WriteCount;
+	char WritePadding[64];
+	std::atomic<bool> WriterClosed;
+	std::atomic<bool> ReaderClosed;
+
+	static void Wait(unsigned int& attempt);
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "ChannelBuffer.h"
+
+ChannelInputBuffer::ChannelInputBuffer(Channel& source, std::ostream& output) : Source(source), Output(output) {}
+
+ChannelInputBuffer::int_type ChannelInputBuffer::underflow()
+{
+	if (gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+
+	if (!Source.CanRead())
+		Output.flush();
+
+	std::size_t count = Source.Read(Buffer, sizeof(Buffer));
+	if (count == 0)
+		return traits_type::eof();
+
+	setg(Buffer, Buffer, Buffer + count);
+	return traits_type::to_int_type(*gptr());
+}
+
+ChannelOutputBuffer::ChannelOutputBuffer(Channel& target, CancellationToken& cancellation) : Target(target), Cancellation(cancellation)
+{
+	setp(Buffer, Buffer + sizeof(Buffer));
+}
+
+ChannelOutputBuffer::int_type ChannelOutputBuffer::overflow(int_type c)
+{
+	sync();
+
+	if (!traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+
+	return traits_type::not_eof(c);
+}
+
+int ChannelOutputBuffer::sync()
+{
+	if (pptr() > pbase() && !Target.Write(pbase(), (std::size_t)(pptr() - pbase())))
+		Cancellation.Cancel();
+
+	setp(Buffer, Buffer + sizeof(Buffer));
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include "Channel.h"
+#include "CancellationToken.h"
+
+// Bytes moved through a channel at once
+static const std::size_t ChannelBatchSize = 4096;
+
+// Reads a stream from a channel. Before waiting for the writer, the output stream is flushed, so batching can't stall whoever produces the input.
+class ChannelInputBuffer : public std::streambuf
+{
+public:
+	ChannelInputBuffer(Channel& source, std::ostream& output);
+
+protected:
+	int_type underflow() override;
+
+private:
+	Channel& Source;
+	std::ostream& Output;
+	char Buffer[ChannelBatchSize];
+};
+
+// Writes a stream to a channel in batches. Once the reader stops reading, output is dropped and the cancellation token is cancelled.
+class ChannelOutputBuffer : public std::streambuf
+{
+public:
+	ChannelOutputBuffer(Channel& target, CancellationToken& cancellation);
+
+protected:
+	int_type overflow(int_type c) override;
+	int sync() override;
+
+private:
+	Channel& Target;
+	CancellationToken& Cancellation;
+	char Buffer[ChannelBatchSize];
+};
\ No newline at end of file
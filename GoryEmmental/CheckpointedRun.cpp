@@ -0,0 +1,174 @@
+#include "CheckpointedRun.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+#include "Emmental.h"
+#include "ExecutionTask.h"
+#include "Checkpoint.h"
+#include "StateCache.h"
+#include "Globals.h"
+
+#if !_WIN32
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+// Steps executed between checks of the clock
+static const std::uint64_t SliceSteps = 16 * 1024;
+
+// Passes input through a symbol at a time, counting the bytes consumed
+class CountingInputBuffer : public std::streambuf
+{
+public:
+	std::uint64_t Count = 0;
+
+	explicit CountingInputBuffer(std::streambuf* source) : Source(source) {}
+
+protected:
+	int_type underflow() override { return Source->sgetc(); }
+
+	int_type uflow() override
+	{
+		int_type c = Source->sbumpc();
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+			Count++;
+
+		return c;
+	}
+
+	std::streamsize showmanyc() override { return Source->in_avail(); }
+
+private:
+	std::streambuf* Source;
+};
+
+// Passes output through, counting the bytes written
+class CountingOutputBuffer : public std::streambuf
+{
+public:
+	std::uint64_t Count = 0;
+
+	explicit CountingOutputBuffer(std::streambuf* target) : Target(target) {}
+
+protected:
+	int_type overflow(int_type c) override
+	{
+		if (traits_type::eq_int_type(c, traits_type::eof()))
+			return traits_type::not_eof(c);
+		if (traits_type::eq_int_type(Target->sputc(traits_type::to_char_type(c)), traits_type::eof()))
+			return traits_type::eof();
+
+		Count++;
+		return c;
+	}
+
+	std::streamsize xsputn(const char* data, std::streamsize size) override
+	{
+		std::streamsize written = Target->sputn(data, size);
+		Count += (std::uint64_t)written;
+		return written;
+	}
+
+	int sync() override { return Target->pubsync(); }
+
+private:
+	std::streambuf* Target;
+};
+
+// Makes sure the output is on the disk before a checkpoint refers to it
+static void SyncOutput()
+{
+#if !_WIN32
+	// Fails harmlessly if the output isn't a file
+	fsync(STDOUT_FILENO);
+#endif
+}
+
+// Cuts the output back to where it was at the checkpoint, dropping what the interrupted run wrote after it
+static void RewindOutput(std::uint64_t offset)
+{
+#if !_WIN32
+	struct stat status;
+	if (fstat(STDOUT_FILENO, &status) != 0 || !S_ISREG(status.st_mode))
+		return;
+
+	if ((std::uint64_t)status.st_size < offset)
+	{
+		if (!Globals::QuietMode)
+			std::cerr << "Warning: The output file is shorter than at the checkpoint, part of the output of the interrupted run is missing." << std::endl;
+
+		return;
+	}
+
+	if (ftruncate(STDOUT_FILENO, (off_t)offset) != 0 || lseek(STDOUT_FILENO, (off_t)offset, SEEK_SET) < 0)
+	{
+		if (!Globals::QuietMode)
+			std::cerr << "Warning: Unable to cut the output file back to the checkpoint." << std::endl;
+	}
+#endif
+}
+
+int CheckpointedRun::Run(const std::vector<char>& program, const std::string& path, std::uint64_t intervalSeconds, bool resume)
+{
+	CountingInputBuffer inputBuffer(std::cin.rdbuf());
+	CountingOutputBuffer outputBuffer(std::cout.rdbuf());
+	std::istream input(&inputBuffer);
+	std::ostream output(&outputBuffer);
+	input.tie(&output);
+
+	Emmental interpreter(input, output, std::cerr);
+
+	ExecutionTask task(interpreter, program.data(), program.size());
+	Checkpoint checkpoint(path, StateCache::GetKey(program));
+
+	if (resume && checkpoint.Exists())
+	{
+		Checkpoint::StreamOffsets offsets;
+		if (!checkpoint.Load(interpreter, task, offsets))
+		{
+			std::cerr << "Error: Unable to resume from checkpoint " << path << ", it's damaged or was saved for another program or other options." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		while (inputBuffer.Count < offsets.Input && !std::streambuf::traits_type::eq_int_type(inputBuffer.sbumpc(), std::streambuf::traits_type::eof()))
+			continue;
+
+		RewindOutput(offsets.Output);
+		outputBuffer.Count = offsets.Output;
+	}
+
+	auto interval = std::chrono::seconds(intervalSeconds);
+	auto nextCheckpoint = std::chrono::steady_clock::now() + interval;
+
+	try
+	{
+		while (task.Run(SliceSteps) != ExecutionTask::Status::Finished)
+		{
+			auto now = std::chrono::steady_clock::now();
+			if (now < nextCheckpoint)
+				continue;
+
+			// Output up to the checkpoint is written before it, so a resumed run continues right after it
+			output.flush();
+			SyncOutput();
+
+			if (!checkpoint.Save(interpreter, task, { inputBuffer.Count, outputBuffer.Count }) && !Globals::QuietMode)
+				std::cerr << "Warning: Unable to write checkpoint " << path << std::endl;
+
+			nextCheckpoint = now + interval;
+		}
+	}
+	catch (...)
+	{
+		// Repeats held back before a checkpoint aren't saved with it, so a resumed run only summarizes its own
+		output.flush();
+		interpreter.SummarizeDiagnostics();
+		throw;
+	}
+
+	output.flush();
+	interpreter.SummarizeDiagnostics();
+	checkpoint.Remove();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Runs a program with the standard input and output as an ExecutionTask, saving a Checkpoint of it at a fixed interval,
+// so a run interrupted by a crash can be resumed from the last checkpoint instead of starting over.
+namespace CheckpointedRun
+{
+	// Checkpoints are stored at path. With resume, the run continues from the stored checkpoint if there is one.
+	// The input of a resumed run must be the same, and its consumed part is skipped. If the output is a file, it's cut back to the checkpoint.
+	int Run(const std::vector<char>& program, const std::string& path, std::uint64_t intervalSeconds, bool resume);
+}
\ No newline at end of file
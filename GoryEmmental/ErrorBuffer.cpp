@@ -0,0 +1,30 @@
+#include "ErrorBuffer.h"
+#include <iostream>
+
+ErrorBuffer::ErrorBuffer(std::mutex& lock, std::string prefix) : Lock(lock), Prefix(std::move(prefix)), AtLineStart(true) {}
+
+ErrorBuffer::int_type ErrorBuffer::overflow(int_type c)
+{
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+		return traits_type::not_eof(c);
+
+	if (AtLineStart)
+		Line += Prefix;
+
+	Line.push_back(traits_type::to_char_type(c));
+	AtLineStart = traits_type::to_char_type(c) == '\n';
+
+	return traits_type::not_eof(c);
+}
+
+int ErrorBuffer::sync()
+{
+	if (Line.empty())
+		return 0;
+
+	std::lock_guard<std::mutex> guard(Lock);
+	std::cerr << Line;
+	std::cerr.flush();
+	Line.clear();
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <mutex>
+#include <streambuf>
+#include <string>
+
+// Writes errors of one of several threads to the standard error, a line at a time, so lines of different threads don't interleave.
+// Every line is preceded by the prefix, if any.
+class ErrorBuffer : public std::streambuf
+{
+public:
+	ErrorBuffer(std::mutex& lock, std::string prefix = "");
+
+protected:
+	int_type overflow(int_type c) override;
+	int sync() override;
+
+private:
+	std::mutex& Lock;
+	std::string Prefix;
+	std::string Line;
+	bool AtLineStart;
+};
\ No newline at end of file
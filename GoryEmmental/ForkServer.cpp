@@ -0,0 +1,290 @@
+#include "ForkServer.h"
+#include <iostream>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <exception>
+#include "Emmental.h"
+#include "EmmentalException.h"
+#include "Globals.h"
+#include "TopLevel.h"
+#include "Quota.h"
+
+#if !_WIN32
+#	include <csignal>
+#	include <unistd.h>
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#endif
+
+#if !_WIN32
+// Protocol, all integers are 32-bit little-endian:
+//   Request:  program length, program bytes, input length, input bytes
+//   Response: exit status, output length, output bytes, error length, error bytes
+
+// Largest program or input a child accepts, so a client can't make it allocate more
+static const std::uint32_t MaxRequestBytes = 64 * 1024 * 1024;
+
+static bool WriteAll(int fd, const char* data, std::size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t written = write(fd, data, length);
+		if (written <= 0)
+			return false;
+
+		data += written;
+		length -= (std::size_t)written;
+	}
+
+	return true;
+}
+
+static bool ReadAll(int fd, char* data, std::size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t result = read(fd, data, length);
+		if (result <= 0)
+			return false;
+
+		data += result;
+		length -= (std::size_t)result;
+	}
+
+	return true;
+}
+
+static bool WriteInteger(int fd, std::uint32_t value)
+{
+	char bytes[4];
+	for (int i = 0; i < 4; i++)
+		bytes[i] = (char)(value >> (i * 8));
+
+	return WriteAll(fd, bytes, sizeof(bytes));
+}
+
+static bool ReadInteger(int fd, std::uint32_t& value)
+{
+	unsigned char bytes[4];
+	if (!ReadAll(fd, (char*)bytes, sizeof(bytes)))
+		return false;
+
+	value = 0;
+	for (int i = 0; i < 4; i++)
+		value |= (std::uint32_t)bytes[i] << (i * 8);
+
+	return true;
+}
+
+static bool WriteBlock(int fd, const std::string& data)
+{
+	return WriteInteger(fd, (std::uint32_t)data.size()) && WriteAll(fd, data.data(), data.size());
+}
+
+static bool ReadBlock(int fd, std::string& data, std::uint32_t maxLength)
+{
+	std::uint32_t length;
+	if (!ReadInteger(fd, length) || length > maxLength)
+		return false;
+
+	data.resize(length);
+	return length == 0 || ReadAll(fd, &data[0], length);
+}
+
+static bool CreateAddress(const std::string& socketPath, sockaddr_un& address)
+{
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (socketPath.size() >= sizeof(address.sun_path))
+		return false;
+
+	std::strcpy(address.sun_path, socketPath.c_str());
+	return true;
+}
+
+static int Interpret(Emmental& interpreter, const std::string& program)
+{
+	int result = EXIT_SUCCESS;
+
+	try
+	{
+		if (Quota::IsLimited())
+		{
+			if (!Quota::Interpret(interpreter, program.data(), program.size()))
+				result = Quota::ExitCode;
+		}
+		else
+			TopLevel::Interpret(interpreter, program.data(), program.size());
+	}
+	catch (const EmmentalException&)
+	{
+		result = EXIT_FAILURE;
+	}
+	catch (const std::exception& e)
+	{
+		// Running out of memory ends the request, not the server or its child without a response
+		interpreter.ErrorStream << "Error: " << e.what() << std::endl;
+		result = EXIT_FAILURE;
+	}
+
+	interpreter.SummarizeDiagnostics();
+	return result;
+}
+
+// Runs in the forked child: executes one request against the child's copy of the prepared interpreter
+static void ServeConnection(int connection, Emmental& interpreter, std::stringstream& input, std::stringstream& output, std::stringstream& error)
+{
+	std::string program;
+	std::string programInput;
+
+	if (!ReadBlock(connection, program, MaxRequestBytes) || !ReadBlock(connection, programInput, MaxRequestBytes))
+		return;
+
+	input.str(programInput);
+	input.clear();
+
+	int status = Interpret(interpreter, program);
+
+	WriteInteger(connection, (std::uint32_t)status);
+	WriteBlock(connection, output.str());
+	WriteBlock(connection, error.str());
+}
+
+int ForkServer::Serve(const std::string& socketPath, const std::vector<char>& prelude)
+{
+	std::stringstream input;
+	std::stringstream output;
+	std::stringstream error;
+	Emmental interpreter(input, output, error);
+
+	// The prelude is run once here, every child starts from the resulting state
+	int preludeStatus = Interpret(interpreter, std::string(prelude.begin(), prelude.end()));
+	std::cout << output.str();
+	std::cerr << error.str();
+	output.str("");
+	error.str("");
+
+	if (preludeStatus != EXIT_SUCCESS)
+		return preludeStatus;
+
+	sockaddr_un address;
+	if (!CreateAddress(socketPath, address))
+	{
+		std::cerr << "Error: Socket path too long: " << socketPath << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+	{
+		std::cerr << "Error: Unable to create socket: " << std::strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	unlink(socketPath.c_str());
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+	{
+		std::cerr << "Error: Unable to listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+		close(listener);
+		return EXIT_FAILURE;
+	}
+
+	// Children are never waited on, let the system reap them
+	std::signal(SIGCHLD, SIG_IGN);
+
+	if (!Globals::QuietMode)
+		std::cerr << "Serving on " << socketPath << std::endl;
+
+	while (true)
+	{
+		int connection = accept(listener, nullptr, nullptr);
+		if (connection < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			std::cerr << "Error: Unable to accept connection: " << std::strerror(errno) << std::endl;
+			close(listener);
+			return EXIT_FAILURE;
+		}
+
+		pid_t child = fork();
+		if (child == 0)
+		{
+			// A client that disconnects early only fails the writes of its response
+			std::signal(SIGPIPE, SIG_IGN);
+			close(listener);
+			ServeConnection(connection, interpreter, input, output, error);
+			close(connection);
+			_exit(EXIT_SUCCESS);
+		}
+
+		if (child < 0 && !Globals::QuietMode)
+			std::cerr << "Error: Unable to fork: " << std::strerror(errno) << std::endl;
+
+		close(connection);
+	}
+}
+
+int ForkServer::Submit(const std::string& socketPath, const std::vector<char>& program, const std::string& input, std::ostream& output, std::ostream& error)
+{
+	sockaddr_un address;
+	if (!CreateAddress(socketPath, address))
+	{
+		error << "Error: Socket path too long: " << socketPath << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (program.size() > MaxRequestBytes || input.size() > MaxRequestBytes)
+	{
+		error << "Error: Programs and inputs sent to a server can be at most " << MaxRequestBytes << " bytes." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connection < 0 || connect(connection, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		error << "Error: Unable to connect to " << socketPath << ": " << std::strerror(errno) << std::endl;
+		if (connection >= 0)
+			close(connection);
+		return EXIT_FAILURE;
+	}
+
+	std::uint32_t status;
+	std::string runOutput;
+	std::string runError;
+
+	bool success = WriteBlock(connection, std::string(program.begin(), program.end()))
+		&& WriteBlock(connection, input)
+		&& ReadInteger(connection, status)
+		&& ReadBlock(connection, runOutput, UINT32_MAX)
+		&& ReadBlock(connection, runError, UINT32_MAX);
+
+	close(connection);
+
+	if (!success)
+	{
+		error << "Error: Connection to server lost." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	output << runOutput;
+	error << runError;
+	return (int)status;
+}
+#else // !_WIN32
+int ForkServer::Serve(const std::string&, const std::vector<char>&)
+{
+	std::cerr << "Error: Server mode is only available on POSIX systems." << std::endl;
+	return EXIT_FAILURE;
+}
+
+int ForkServer::Submit(const std::string&, const std::vector<char>&, const std::string&, std::ostream&, std::ostream& error)
+{
+	error << "Error: Server mode is only available on POSIX systems." << std::endl;
+	return EXIT_FAILURE;
+}
+#endif // !_WIN32
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+
+// Long-lived server mode: a prelude is executed once, and every run request is served by a forked copy of the prepared interpreter.
+// Only available on POSIX systems.
+namespace ForkServer
+{
+	// Executes the prelude, then listens on a Unix domain socket and serves run requests forever. Returns only if the server fails.
+	int Serve(const std::string& socketPath, const std::vector<char>& prelude);
+	// Sends a program and its input to a server, writes the run's output and errors, and returns the run's exit status.
+	int Submit(const std::string& socketPath, const std::vector<char>& program, const std::string& input, std::ostream& output, std::ostream& error);
+}
\ No newline at end of file
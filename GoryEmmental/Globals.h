@@ -1,13 +0,0 @@
-#pragma once
-
-namespace Globals
-{
-	extern bool DebugMode;
-	extern bool UseVirtualConsole;
-	extern bool OptimizeProgram;
-	extern bool IgnoreWhitespace;
-	extern bool QuietMode;
-	extern bool LenientMode;
-
-	void Initialize();
-}
\ No newline at end of file
@@ -1,11 +1,25 @@
 #include <iomanip>
+#include <csignal>
+#include <climits>
+#include <vector>
 #include "InteractiveInterpreter.h"
 #include "InterpretedDefinition.h"
+#include "EmmentalException.h"
 #include "Util.h"
 #include "Globals.h"
 
+// Cancelled by SIGINT while a program runs
+static CancellationToken InterruptToken;
+
+static void HandleInterrupt(int)
+{
+	InterruptToken.Cancel();
+	// Some platforms reset the handler before calling it
+	std::signal(SIGINT, HandleInterrupt);
+}
+
 InteractiveInterpreter::InteractiveInterpreter(Emmental& interpreter)
-	: Interpreter(interpreter)
+	: Interpreter(interpreter), ProgramDebugger(interpreter)
 {
 	GenerateCommands();
 }
@@ -35,18 +49,208 @@ int InteractiveInterpreter::RunLoop()
 				continue;
 		}
 
+		RunCancellable([&]() { InterpretInput(input); });
+
+		if (Globals::DebugMode)
+		{
+			Util::DescribeMemory(Interpreter, Interpreter.OutputStream);
+			Interpreter.OutputStream << std::endl;
+		}
+	}
+}
+
+void InteractiveInterpreter::RunCancellable(const std::function<void()>& run)
+{
+	// Ctrl+C only stops the running program, the stack, queue and definitions are kept as they were
+	InterruptToken.Reset();
+	Interpreter.SetCancellationToken(&InterruptToken);
+	auto previousHandler = std::signal(SIGINT, HandleInterrupt);
+
+	try
+	{
+		run();
+	}
+	catch (const CancelledException&)
+	{
+		Util::Colorize(Util::ConsoleColor::BrightYellow, Interpreter.OutputStream);
+		Interpreter.OutputStream << "Program cancelled." << std::endl;
+		Util::Colorize(Util::ConsoleColor::Default, Interpreter.OutputStream);
+	}
+
+	std::signal(SIGINT, previousHandler);
+	Interpreter.SetCancellationToken(nullptr);
+	Interpreter.SummarizeDiagnostics();
+}
+
+void InteractiveInterpreter::InterpretInput(const std::string& input)
+{
+	if (ProgramDebugger.IsPaused())
+	{
+		ProgramDebugger.Abandon();
+		Interpreter.OutputStream << "Abandoned the paused program." << std::endl;
+	}
+
+	// Without breakpoints, the input is interpreted directly, at full speed
+	if (!ProgramDebugger.IsActive())
+	{
 		for (auto&& x : input)
 		{
-			SymbolT symbol = (SymbolT)x;
+			SymbolT symbol = (unsigned char)x;
 			Interpreter.Interpret(symbol);
 		}
 
-		if (Globals::DebugMode)
+		return;
+	}
+
+	DescribePause(ProgramDebugger.Start(input.data(), input.size()), false);
+}
+
+static bool IsWatchpoint(Debugger::BreakpointKind kind)
+{
+	return kind == Debugger::BreakpointKind::StackSize || kind == Debugger::BreakpointKind::QueueSize || kind == Debugger::BreakpointKind::Redefinition;
+}
+
+static void PrintCommandError(const std::string& message, std::ostream& output)
+{
+	Util::Colorize(Util::ConsoleColor::Red, output);
+	output << message << std::endl;
+	Util::Colorize(Util::ConsoleColor::Default, output);
+}
+
+// Parses an argument of the debugger commands, printing an error if it isn't a number
+static bool ParseNumber(const std::string& text, std::uint64_t& value, std::ostream& output)
+{
+	try
+	{
+		std::size_t length;
+		value = std::stoull(text, &length);
+
+		if (length == text.size() && text.find('-') == std::string::npos)
+			return true;
+	}
+	catch (std::invalid_argument)
+	{
+	}
+	catch (std::out_of_range)
+	{
+		PrintCommandError("Number out of range.", output);
+		return false;
+	}
+
+	PrintCommandError("Invalid number '" + text + "'.", output);
+	return false;
+}
+
+// Adds a breakpoint or watchpoint from an argument made of one of the given names and a number
+static void AddBreakpoint(Debugger& debugger, const std::string& arg, const std::vector<std::pair<std::string, Debugger::BreakpointKind>>& kinds,
+	std::ostream& output)
+{
+	auto spaceLocation = arg.find(' ');
+	std::string name = arg.substr(0, spaceLocation);
+	std::string number = spaceLocation == std::string::npos ? "" : arg.substr(spaceLocation + 1);
+
+	for (auto& kind : kinds)
+	{
+		if (kind.first != name)
+			continue;
+
+		std::uint64_t value;
+		if (!ParseNumber(number, value, output))
+			return;
+
+		unsigned int id = debugger.AddBreakpoint(kind.second, value);
+		if (id == 0)
 		{
-			Util::DescribeMemory(Interpreter, Interpreter.OutputStream);
-			Interpreter.OutputStream << std::endl;
+			PrintCommandError("Symbol " + std::to_string(value) + " is undefined, so it has no definition to break at.", output);
+			return;
 		}
+
+		output << (IsWatchpoint(kind.second) ? "Watchpoint " : "Breakpoint ") << id << " set." << std::endl;
+		return;
 	}
+
+	std::string names;
+	for (std::size_t i = 0; i < kinds.size(); i++)
+		names += (i == 0 ? "'" : i + 1 == kinds.size() ? " or '" : ", '") + kinds[i].first + "'";
+
+	PrintCommandError("Unknown argument '" + arg + "'. Use " + names + " followed by a number.", output);
+}
+
+static void DescribeBreakpoint(const Debugger::Breakpoint& breakpoint, std::ostream& output)
+{
+	switch (breakpoint.Kind)
+	{
+	case Debugger::BreakpointKind::Symbol:
+		output << "symbol ";
+		Util::DescribeSymbol(breakpoint.Value, output);
+		break;
+
+	case Debugger::BreakpointKind::Definition:
+		output << "definition ";
+		Util::DescribeDefinition(breakpoint.Value, breakpoint.Definition.get(), false, output);
+		break;
+
+	case Debugger::BreakpointKind::Position: output << "position " << breakpoint.Value; break;
+	case Debugger::BreakpointKind::StackSize: output << "stack size " << breakpoint.Value; break;
+	case Debugger::BreakpointKind::QueueSize: output << "queue size " << breakpoint.Value; break;
+
+	case Debugger::BreakpointKind::Redefinition:
+		output << "redefinition of ";
+		Util::DescribeSymbol(breakpoint.Value, output);
+		break;
+	}
+}
+
+void InteractiveInterpreter::DescribePause(Debugger::Status status, bool announceFinish)
+{
+	std::ostream& output = Interpreter.OutputStream;
+
+	if (status == Debugger::Status::Finished)
+	{
+		if (announceFinish)
+			output << "Program finished." << std::endl;
+
+		return;
+	}
+
+	Util::Colorize(Util::ConsoleColor::BrightYellow, output);
+	output << "Paused";
+	Util::Colorize(Util::ConsoleColor::Default, output);
+
+	const Debugger::Breakpoint* hit = ProgramDebugger.GetHit();
+	if (hit)
+	{
+		output << (IsWatchpoint(hit->Kind) ? " after watchpoint " : " at breakpoint ") << hit->Id << " (";
+		DescribeBreakpoint(*hit, output);
+		output << ")";
+	}
+
+	std::uint64_t steps = ProgramDebugger.GetStepCount();
+	output << " after " << steps << (steps == 1 ? " step." : " steps.") << std::endl;
+
+	ExecutionTask::NextStep next;
+	if (ProgramDebugger.GetNextStep(next))
+	{
+		output << "Next: ";
+		Util::DescribeSymbol(next.Symbol, output);
+		output << " at position " << next.Position << ", recursion level " << next.RecursionLevel << std::endl;
+
+		// The next symbol of a definition is the first one after the bar
+		if (next.Caller)
+		{
+			ProgramT program = next.Caller->GetProgram();
+			output << "In definition: ";
+			Util::DescribeProgram(ProgramT(program.begin(), program.begin() + next.CallerPosition), output);
+			output << " | ";
+			Util::DescribeProgram(ProgramT(program.begin() + next.CallerPosition, program.end()), output);
+			output << std::endl;
+		}
+	}
+	else
+		output << "Next: End of the program" << std::endl;
+
+	Util::DescribeMemory(Interpreter, output);
+	output << std::endl;
 }
 
 void InteractiveInterpreter::AddCommand(const InteractiveCommand& command) { Commands.push_back(command); }
@@ -147,23 +351,23 @@ void InteractiveInterpreter::GenerateCommands()
 			}
 			else if (arg == "optimize")
 			{
-				Globals::OptimizeProgram = !Globals::OptimizeProgram;
-				interpreter.OutputStream << "Optimization is now " << (Globals::OptimizeProgram ? "on" : "off") << "." << std::endl;
+				interpreter.GetOptions().OptimizeProgram = !interpreter.GetOptions().OptimizeProgram;
+				interpreter.OutputStream << "Optimization is now " << (interpreter.GetOptions().OptimizeProgram ? "on" : "off") << "." << std::endl;
 			}
 			else if (arg == "nowhitespace")
 			{
-				Globals::IgnoreWhitespace = !Globals::IgnoreWhitespace;
-				interpreter.OutputStream << "Whitespace is now " << (Globals::IgnoreWhitespace ? "ignored" : "interpreted normally") << "." << std::endl;
+				interpreter.GetOptions().IgnoreWhitespace = !interpreter.GetOptions().IgnoreWhitespace;
+				interpreter.OutputStream << "Whitespace is now " << (interpreter.GetOptions().IgnoreWhitespace ? "ignored" : "interpreted normally") << "." << std::endl;
 			}
 			else if (arg == "quiet")
 			{
-				Globals::QuietMode = !Globals::QuietMode;
-				interpreter.OutputStream << "Quiet Mode is now " << (Globals::QuietMode ? "on" : "off") << "." << std::endl;
+				interpreter.GetOptions().QuietMode = !interpreter.GetOptions().QuietMode;
+				interpreter.OutputStream << "Quiet Mode is now " << (interpreter.GetOptions().QuietMode ? "on" : "off") << "." << std::endl;
 			}
 			else if (arg == "lenient")
 			{
-				Globals::LenientMode = !Globals::LenientMode;
-				interpreter.OutputStream << "Errors are now" << (Globals::LenientMode ? " considered warnings" : " fatal") << "." << std::endl;
+				interpreter.GetOptions().LenientMode = !interpreter.GetOptions().LenientMode;
+				interpreter.OutputStream << "Errors are now" << (interpreter.GetOptions().LenientMode ? " considered warnings" : " fatal") << "." << std::endl;
 			}
 			else
 			{
@@ -187,8 +391,8 @@ void InteractiveInterpreter::GenerateCommands()
 	{
 		for (auto& symbol : args)
 		{
-			interpreter.Push(symbol);
-			Util::DescribeSymbol(symbol, interpreter.OutputStream);
+			interpreter.Push((unsigned char)symbol);
+			Util::DescribeSymbol((unsigned char)symbol, interpreter.OutputStream);
 			interpreter.OutputStream << ", ";
 		}
 
@@ -239,6 +443,87 @@ void InteractiveInterpreter::GenerateCommands()
 		}
 	}));
 
+	AddCommand(InteractiveCommand("break",
+		"Without argument: Lists all breakpoints and watchpoints. With 'symbol', 'def' or 'pos' and a number as arguments: "
+		"Pauses programs before executing that symbol, calling the current definition of that symbol, or executing the symbol at that position of an input.",
+		[&](Emmental& interpreter, std::string arg)
+	{
+		if (!arg.empty())
+		{
+			AddBreakpoint(ProgramDebugger, arg, { { "symbol", Debugger::BreakpointKind::Symbol }, { "def", Debugger::BreakpointKind::Definition },
+				{ "pos", Debugger::BreakpointKind::Position } }, interpreter.OutputStream);
+			return;
+		}
+
+		for (auto& breakpoint : ProgramDebugger.GetBreakpoints())
+		{
+			interpreter.OutputStream << (IsWatchpoint(breakpoint.Kind) ? "Watchpoint " : "Breakpoint ") << breakpoint.Id << ": ";
+			DescribeBreakpoint(breakpoint, interpreter.OutputStream);
+			interpreter.OutputStream << std::endl;
+		}
+
+		interpreter.OutputStream << ProgramDebugger.GetBreakpoints().size() << " breakpoints and watchpoints" << std::endl;
+	}));
+
+	AddCommand(InteractiveCommand("watch",
+		"With 'stack' or 'queue' and a number as arguments: Pauses programs after the stack or queue grows to that many symbols. "
+		"With 'def' and a symbol number: Pauses programs after that symbol is redefined.",
+		[&](Emmental& interpreter, std::string arg)
+	{
+		AddBreakpoint(ProgramDebugger, arg, { { "stack", Debugger::BreakpointKind::StackSize }, { "queue", Debugger::BreakpointKind::QueueSize },
+			{ "def", Debugger::BreakpointKind::Redefinition } }, interpreter.OutputStream);
+	}));
+
+	AddCommand(InteractiveCommand("delete", "Deletes the breakpoint or watchpoint with the number passed as an argument, or all of them with 'all'.",
+		[&](Emmental& interpreter, std::string arg)
+	{
+		if (arg == "all")
+		{
+			ProgramDebugger.ClearBreakpoints();
+			interpreter.OutputStream << "All breakpoints and watchpoints deleted." << std::endl;
+			return;
+		}
+
+		std::uint64_t id;
+		if (!ParseNumber(arg, id, interpreter.OutputStream))
+			return;
+
+		if (id > UINT_MAX || !ProgramDebugger.RemoveBreakpoint((unsigned int)id))
+			PrintCommandError("There's no breakpoint or watchpoint " + arg + ".", interpreter.OutputStream);
+		else
+			interpreter.OutputStream << "Deleted " << id << "." << std::endl;
+	}));
+
+	AddCommand(InteractiveCommand("step",
+		"Executes a step of the paused program, or the number of steps passed as an argument. Without a paused program, pauses the next input before its first step.",
+		[&](Emmental& interpreter, std::string arg)
+	{
+		std::uint64_t count = 1;
+		if (!arg.empty() && !ParseNumber(arg, count, interpreter.OutputStream))
+			return;
+
+		if (!ProgramDebugger.IsPaused())
+		{
+			ProgramDebugger.RequestPause();
+			interpreter.OutputStream << "The next input will pause before its first step." << std::endl;
+			return;
+		}
+
+		RunCancellable([&]() { DescribePause(ProgramDebugger.Step(count), true); });
+	}));
+
+	AddCommand(InteractiveCommand("continue", "Continues the paused program until it finishes, or pauses at a breakpoint or watchpoint.",
+		[&](Emmental& interpreter, std::string)
+	{
+		if (!ProgramDebugger.IsPaused())
+		{
+			PrintCommandError("No program is paused.", interpreter.OutputStream);
+			return;
+		}
+
+		RunCancellable([&]() { DescribePause(ProgramDebugger.Continue(), true); });
+	}));
+
 	AddCommand(InteractiveCommand("info", "Display interpreter information.", [](Emmental& interpreter, std::string)
 	{
 		interpreter.OutputStream << "Gory Emmental Interpreter 1.0.0 by Davipb" << std::endl;
@@ -248,8 +533,7 @@ void InteractiveInterpreter::GenerateCommands()
 		Util::Colorize(Util::ConsoleColor::Default, interpreter.OutputStream);
 		interpreter.OutputStream << "Symbol Type: " << typeid(SymbolT).name() << std::endl;
 		interpreter.OutputStream << "Symbol Size: " << sizeof(SymbolT) << " byte(s)" << std::endl;
-		interpreter.OutputStream << "Max Stack Size: " << EMMENTAL_MAX_STACK_SIZE << std::endl;
-		interpreter.OutputStream << "Max Queue Size: " << EMMENTAL_MAX_QUEUE_SIZE << std::endl;
+		interpreter.OutputStream << "Cell Width: " << interpreter.GetCellWidth() << " bit(s)" << std::endl;
 		interpreter.OutputStream << "Max Recursion Level: " << EMMENTAL_MAX_RECURSION_LEVEL << std::endl;
 
 		Util::Colorize(Util::ConsoleColor::BrightGreen, interpreter.OutputStream);
@@ -257,10 +541,13 @@ void InteractiveInterpreter::GenerateCommands()
 		Util::Colorize(Util::ConsoleColor::Default, interpreter.OutputStream);
 		interpreter.OutputStream << "Debug Mode: " << (Globals::DebugMode ? "On" : "Off") << std::endl;
 		interpreter.OutputStream << "Colors: " << (Globals::UseVirtualConsole ? "On" : "Off") << std::endl;
-		interpreter.OutputStream << "Optimization: " << (Globals::OptimizeProgram ? "On" : "Off") << std::endl;
-		interpreter.OutputStream << "Ignore Whitespace: " << (Globals::IgnoreWhitespace ? "On" : "Off") << std::endl;
-		interpreter.OutputStream << "Quiet Mode: " << (Globals::QuietMode ? "On" : "Off") << std::endl;
-		interpreter.OutputStream << "Lenient Mode: " << (Globals::LenientMode ? "On" : "Off") << std::endl;
+		interpreter.OutputStream << "Optimization: " << (interpreter.GetOptions().OptimizeProgram ? "On" : "Off") << std::endl;
+		interpreter.OutputStream << "Max Stack Size: " << interpreter.GetMaxStackSize() << std::endl;
+		interpreter.OutputStream << "Max Queue Size: " << interpreter.GetMaxQueueSize() << std::endl;
+		interpreter.OutputStream << "Spill Directory: " << (Globals::SpillDirectory.empty() ? "None" : Globals::SpillDirectory) << std::endl;
+		interpreter.OutputStream << "Ignore Whitespace: " << (interpreter.GetOptions().IgnoreWhitespace ? "On" : "Off") << std::endl;
+		interpreter.OutputStream << "Quiet Mode: " << (interpreter.GetOptions().QuietMode ? "On" : "Off") << std::endl;
+		interpreter.OutputStream << "Lenient Mode: " << (interpreter.GetOptions().LenientMode ? "On" : "Off") << std::endl;
 
 	}));
 }
@@ -3,6 +3,7 @@
 #include <list>
 #include <string>
 #include "Emmental.h"
+#include "Debugger.h"
 
 class InteractiveInterpreter final
 {
@@ -31,8 +32,15 @@ public:
 
 private:
 	Emmental& Interpreter;
+	Debugger ProgramDebugger;
 	std::list<InteractiveCommand> Commands;
 	void GenerateCommands();
 	bool ParseCommand(std::string input);
+	// Runs code that executes a program, so that Ctrl+C cancels the program instead of exiting
+	void RunCancellable(const std::function<void()>& run);
+	// Interprets a line of input, through the debugger if it could pause
+	void InterpretInput(const std::string& input);
+	// Describes where the debugger paused, or that the program finished if announceFinish is set
+	void DescribePause(Debugger::Status status, bool announceFinish);
 };
 
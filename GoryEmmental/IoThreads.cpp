@@ -0,0 +1,105 @@
+#include "IoThreads.h"
+#include <cerrno>
+#include <vector>
+
+#if _WIN32
+#	include <io.h>
+#else
+#	include <unistd.h>
+#endif
+
+// Bytes read from the standard input at once
+static const std::size_t InputChunkSize = 64 * 1024;
+// Bytes written to the standard output at once
+static const std::size_t OutputChunkSize = 64 * 1024;
+static const std::size_t ChannelCapacity = 1024 * 1024;
+
+// Reads up to size bytes from a file descriptor. Returns 0 at the end of the file or on an error.
+static std::size_t ReadSome(int descriptor, char* data, std::size_t size)
+{
+	while (true)
+	{
+#if _WIN32
+		int count = _read(descriptor, data, (unsigned int)size);
+#else
+		ssize_t count = read(descriptor, data, size);
+#endif
+
+		if (count >= 0)
+			return (std::size_t)count;
+		if (errno != EINTR)
+			return 0;
+	}
+}
+
+static bool WriteAll(int descriptor, const char* data, std::size_t size)
+{
+	while (size > 0)
+	{
+#if _WIN32
+		int count = _write(descriptor, data, (unsigned int)size);
+#else
+		ssize_t count = write(descriptor, data, size);
+#endif
+
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return false;
+
+		data += count;
+		size -= (std::size_t)count;
+	}
+
+	return true;
+}
+
+IoThreads::IoThreads(CancellationToken& cancellation)
+	: InputChannel(std::make_shared<Channel>(ChannelCapacity)), OutputChannel(ChannelCapacity),
+	OutputBuffer(OutputChannel, cancellation), Output(&OutputBuffer), InputBuffer(*InputChannel, Output), Input(&InputBuffer)
+{
+	std::shared_ptr<Channel> inputChannel = InputChannel;
+	std::thread([inputChannel]()
+	{
+		std::vector<char> buffer(InputChunkSize);
+
+		while (std::size_t count = ReadSome(0, buffer.data(), buffer.size()))
+		{
+			if (!inputChannel->Write(buffer.data(), count))
+				return;
+		}
+
+		inputChannel->CloseWriter();
+	}).detach();
+
+	OutputThread = std::thread([this]()
+	{
+		std::vector<char> buffer(OutputChunkSize);
+
+		while (std::size_t count = OutputChannel.Read(buffer.data(), buffer.size()))
+		{
+			if (!WriteAll(1, buffer.data(), count))
+			{
+				OutputChannel.CloseReader();
+				return;
+			}
+		}
+	});
+}
+
+IoThreads::~IoThreads()
+{
+	Finish();
+}
+
+void IoThreads::Finish()
+{
+	if (Finished)
+		return;
+
+	Finished = true;
+	Output.flush();
+	OutputChannel.CloseWriter();
+	OutputThread.join();
+	InputChannel->CloseReader();
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include "Channel.h"
+#include "ChannelBuffer.h"
+#include "CancellationToken.h"
+
+// Moves the standard input and output through channels on background threads, which own the file descriptors.
+// The input thread reads ahead in large chunks, and the output thread writes one batch while the interpreter fills the next,
+// so the interpreter only waits for the devices when the input runs out or the output falls far behind.
+class IoThreads
+{
+public:
+	// The cancellation token is cancelled once the standard output can't be written anymore
+	explicit IoThreads(CancellationToken& cancellation);
+	~IoThreads();
+
+	IoThreads(const IoThreads&) = delete;
+	IoThreads& operator=(const IoThreads&) = delete;
+
+	// Output is flushed before waiting for input
+	std::istream& GetInput() { return Input; }
+	std::ostream& GetOutput() { return Output; }
+
+	// Waits until all output is written, and stops reading input. Called by the destructor if needed.
+	void Finish();
+
+private:
+	// Shared with the input thread, which is left blocked on the device if the input never ends
+	std::shared_ptr<Channel> InputChannel;
+	Channel OutputChannel;
+	ChannelOutputBuffer OutputBuffer;
+	std::ostream Output;
+	ChannelInputBuffer InputBuffer;
+	std::istream Input;
+	std::thread OutputThread;
+	bool Finished = false;
+};
\ No newline at end of file
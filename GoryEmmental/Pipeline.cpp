@@ -0,0 +1,70 @@
+#include "Pipeline.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Channel.h"
+#include "ChannelBuffer.h"
+#include "ErrorBuffer.h"
+
+static const std::size_t ChannelCapacity = 64 * 1024;
+
+int Pipeline::Run(std::size_t stageCount, const Stage& stage)
+{
+	std::vector<std::unique_ptr<Channel>> channels;
+	for (std::size_t i = 0; i + 1 < stageCount; i++)
+		channels.emplace_back(new Channel(ChannelCapacity));
+
+	std::vector<CancellationToken> cancellations(stageCount);
+	std::vector<int> statuses(stageCount, EXIT_SUCCESS);
+	std::vector<std::thread> threads;
+	std::mutex errorLock;
+
+	for (std::size_t i = 0; i < stageCount; i++)
+	{
+		threads.emplace_back([&, i]()
+		{
+			std::unique_ptr<ChannelOutputBuffer> outputBuffer;
+			if (i + 1 < stageCount)
+				outputBuffer.reset(new ChannelOutputBuffer(*channels[i], cancellations[i]));
+
+			std::ostream output(outputBuffer ? static_cast<std::streambuf*>(outputBuffer.get()) : std::cout.rdbuf());
+
+			// Standard input may block without telling, so the first stage flushes its output before every read instead
+			std::unique_ptr<ChannelInputBuffer> inputBuffer;
+			if (i > 0)
+				inputBuffer.reset(new ChannelInputBuffer(*channels[i - 1], output));
+
+			std::istream input(inputBuffer ? static_cast<std::streambuf*>(inputBuffer.get()) : std::cin.rdbuf());
+			if (i == 0)
+				input.tie(&output);
+
+			ErrorBuffer errorBuffer(errorLock);
+			std::ostream error(&errorBuffer);
+
+			statuses[i] = stage(i, input, output, error, cancellations[i]);
+			output.flush();
+			error.flush();
+
+			// The end of the stream reaches the next stage after everything written, and the previous stage is stopped
+			if (i + 1 < stageCount)
+				channels[i]->CloseWriter();
+			if (i > 0)
+				channels[i - 1]->CloseReader();
+		});
+	}
+
+	int status = EXIT_SUCCESS;
+
+	for (std::size_t i = 0; i < stageCount; i++)
+	{
+		threads[i].join();
+
+		if (statuses[i] != EXIT_SUCCESS)
+			status = statuses[i];
+	}
+
+	return status;
+}
\ No newline at end of file
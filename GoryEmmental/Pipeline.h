@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include "CancellationToken.h"
+
+// Runs stages on their own threads, each stage's output feeding the next stage's input through a Channel.
+// The first stage reads the standard input, and the last one writes the standard output.
+namespace Pipeline
+{
+	// Runs a stage with its streams, and returns its exit status. The cancellation token is cancelled once the next stage stops reading.
+	using Stage = std::function<int(std::size_t index, std::istream& input, std::ostream& output, std::ostream& error, const CancellationToken& cancellation)>;
+
+	// Runs every stage to completion, and returns the last unsuccessful exit status, or EXIT_SUCCESS if all stages succeeded.
+	int Run(std::size_t stageCount, const Stage& stage);
+}
\ No newline at end of file
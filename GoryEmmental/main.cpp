@@ -2,48 +2,87 @@
 #include <string>
 #include <fstream>
 #include <cctype>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+#include <chrono>
+#include <memory>
 #include "Emmental.h"
 #include "InterpretedDefinition.h"
 #include "InteractiveInterpreter.h"
 #include "Util.h"
 #include "Globals.h"
+#include "StateCache.h"
+#include "ForkServer.h"
+#include "TopLevel.h"
+#include "Quota.h"
+#include "Pipeline.h"
+#include "Batch.h"
+#include "IoThreads.h"
+#include "CheckpointedRun.h"
+#include "ProgramImage.h"
+#include "ScratchFile.h"
+#include "EmmentalException.h"
+#include "EmmentalApi.h"
 #include "tclap\CmdLine.h"
 
-int InterpretFile(const std::string& filename)
+// Interprets the symbols of a program in the range [begin, end)
+static void InterpretRange(Emmental& interpreter, const std::vector<char>& program, std::size_t begin, std::size_t end)
 {
-	Emmental interpreter(std::cin, std::cout, std::cerr);	
+	// Debug mode prints after every symbol, so the program can't be compiled
+	if (!Globals::DebugMode)
+	{
+		TopLevel::Interpret(interpreter, program.data() + begin, end - begin);
+		return;
+	}
+
+	for (std::size_t i = begin; i < end; i++)
+	{
+		SymbolT symbol = (unsigned char)program[i];
+
+		if (interpreter.GetOptions().IgnoreWhitespace && std::isspace(symbol))
+			continue;
+
+		interpreter.Interpret(symbol);
+
+		if (!interpreter.GetOptions().QuietMode)
+		{
+			std::cout << std::endl;
+			std::cout << "Interpreted Symbol: ";
+			Util::DescribeSymbol(symbol, std::cout);
+			std::cout << std::endl;
+			Util::DescribeMemory(interpreter, std::cout);
+			std::cout << std::endl;
+		}
+	}
+}
 
+// Interprets the longest prefix of a program that has no observable effects, caches the resulting state and returns the prefix length.
+static std::size_t WarmUp(Emmental& interpreter, const std::vector<char>& program, const std::string& cachePath, std::uint64_t cacheKey)
+{
+	std::size_t end = TopLevel::InterpretPrefix(interpreter, program.data(), program.size());
+
+	if (!StateCache::Save(cachePath, cacheKey, interpreter, end) && !Globals::QuietMode)
+		std::cerr << "Warning: Unable to write cache file " << cachePath << std::endl;
+
+	return end;
+}
+
+// Reads a whole file into memory. Returns false and prints an error if it can't be read.
+static bool ReadFile(const std::string& filename, std::vector<char>& contents)
+{
 #if _WIN32 && _UNICODE
 	// Open file using UTF16 filename
 	// Non-Standard MSVC extension, allows usage of std::wstring for Unicode filenames
-	std::basic_ifstream<SymbolT> file(Util::ToUtf16(filename), std::ios_base::binary | std::ios_base::in);
+	std::ifstream file(Util::ToUtf16(filename), std::ios_base::binary | std::ios_base::in);
 #else // _WIN32 && _UNICODE
-	std::basic_ifstream<SymbolT> file(filename, std::ios_base::binary | std::ios_base::in);
+	std::ifstream file(filename, std::ios_base::binary | std::ios_base::in);
 #endif // _WIN32 && _UNICODE
-	
+
 	try
 	{
 		file.exceptions(decltype(file)::failbit);
-
-		SymbolT symbol;
-		while (file.get(symbol))
-		{
-			if (Globals::IgnoreWhitespace && std::isspace(symbol))
-				continue;
-
-			interpreter.Interpret(symbol);
-
-			if (Globals::DebugMode && !Globals::QuietMode)
-			{
-				std::cout << std::endl;
-				std::cout << "Interpreted Symbol: ";
-				Util::DescribeSymbol(symbol, std::cout);
-				std::cout << std::endl;
-				Util::DescribeMemory(interpreter, std::cout);
-				std::cout << std::endl;
-			}
-		}
-
+		contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
 		file.close();
 	}
 	catch (const decltype(file)::failure& fail)
@@ -53,17 +92,261 @@ int InterpretFile(const std::string& filename)
 			if (!Globals::QuietMode)
 				std::cerr << "Error " << fail.code() << " while trying to read file: " << fail.what() << std::endl;
 
-			return EXIT_FAILURE;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Interprets a whole program, resuming from the cached state after its input-independent prefix if a cache is selected
+static int InterpretProgram(Emmental& interpreter, const std::vector<char>& program)
+{
+	// The whole run counts towards the quotas and the statistics, so the prefix isn't cached
+	if (Quota::IsLimited())
+		return Quota::Interpret(interpreter, program.data(), program.size()) ? EXIT_SUCCESS : Quota::ExitCode;
+
+	std::size_t offset = 0;
+
+	// Debug mode prints after every symbol, so the prefix can't be skipped
+	if (!Globals::CacheDirectory.empty() && !Globals::DebugMode && !Globals::CollectStats)
+	{
+		std::uint64_t cacheKey = StateCache::GetKey(program);
+		std::string cachePath = StateCache::GetPath(Globals::CacheDirectory, cacheKey);
+
+		// A damaged cache is rebuilt, from a clean state
+		if (!StateCache::Load(cachePath, cacheKey, interpreter, offset) || offset > program.size())
+		{
+			interpreter.Reset();
+			offset = WarmUp(interpreter, program, cachePath, cacheKey);
 		}
 	}
 
+	InterpretRange(interpreter, program, offset, program.size());
 	return EXIT_SUCCESS;
 }
 
+// Prints the statistics an interpreter collected as text to the standard error, and writes them as JSON to a file if one is selected
+static void ReportStats(Emmental& interpreter, double seconds, bool printStats, const std::string& statsPath)
+{
+	// The report follows the program's output
+	interpreter.OutputStream.flush();
+
+	if (printStats)
+		interpreter.GetStats()->Print(std::cerr, seconds);
+
+	if (!statsPath.empty())
+	{
+		std::ofstream file(statsPath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+		interpreter.GetStats()->PrintJson(file, seconds);
+
+		if (!file.flush() && !Globals::QuietMode)
+			std::cerr << "Warning: Unable to write statistics file " << statsPath << std::endl;
+	}
+}
+
+// Summarizes the diagnostics an interpreter held back, and reports the statistics it collected if any
+static void ReportRun(Emmental& interpreter, double seconds, bool printStats, const std::string& statsPath)
+{
+	interpreter.SummarizeDiagnostics();
+
+	if (interpreter.GetStats())
+		ReportStats(interpreter, seconds, printStats, statsPath);
+}
+
+// Interprets a whole program like InterpretProgram(), and reports on the run once it stops, even if it stops with an error
+static int InterpretProgramAndReport(Emmental& interpreter, const std::vector<char>& program, bool printStats, const std::string& statsPath)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto getSeconds = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+
+	try
+	{
+		int result = InterpretProgram(interpreter, program);
+		ReportRun(interpreter, getSeconds(), printStats, statsPath);
+		return result;
+	}
+	catch (...)
+	{
+		ReportRun(interpreter, getSeconds(), printStats, statsPath);
+		throw;
+	}
+}
+
+// Interprets a whole program through the C interface, with the standard streams as its input and output
+static int InterpretWithApi(const std::vector<char>& program)
+{
+	auto read = [](void*, unsigned char* buffer, size_t capacity) -> size_t
+	{
+		// Only the first byte waits for input, so a prompt gets its answer without waiting for a whole buffer
+		std::istream::int_type first = std::cin.get();
+		if (first == std::istream::traits_type::eof())
+			return 0;
+
+		buffer[0] = (unsigned char)first;
+		return 1 + (size_t)std::cin.readsome(reinterpret_cast<char*>(buffer) + 1, (std::streamsize)(capacity - 1));
+	};
+	auto write = [](void*, const char* data, size_t size) { std::cout.write(data, (std::streamsize)size); };
+	auto error = [](void*, const char* data, size_t size) { std::cerr.write(data, (std::streamsize)size); };
+
+	std::unique_ptr<emmental_interpreter, void (*)(emmental_interpreter*)> interpreter(emmental_create(read, write, error, nullptr), emmental_destroy);
+	if (!interpreter || emmental_feed(interpreter.get(), program.data(), program.size()) != 0)
+	{
+		if (!Globals::QuietMode)
+			std::cerr << "Error: Out of memory." << std::endl;
+
+		return EXIT_FAILURE;
+	}
+
+	// Errors were already printed by the interpreter
+	return emmental_run(interpreter.get(), 0) == EMMENTAL_FINISHED ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int InterpretFile(const std::string& filename, bool useIoThreads, bool printStats, const std::string& statsPath)
+{
+	std::vector<char> program;
+	if (!ReadFile(filename, program))
+		return EXIT_FAILURE;
+
+	// Runs without quotas, statistics, a cache or debugging only need what the C interface offers
+	if (!useIoThreads && !Quota::IsLimited() && !Globals::CollectStats && Globals::CacheDirectory.empty() && !Globals::DebugMode)
+		return InterpretWithApi(program);
+
+	if (!useIoThreads)
+	{
+		Emmental interpreter(std::cin, std::cout, std::cerr);
+		return InterpretProgramAndReport(interpreter, program, printStats, statsPath);
+	}
+
+	CancellationToken cancellation;
+	IoThreads io(cancellation);
+	Emmental interpreter(io.GetInput(), io.GetOutput(), std::cerr);
+	interpreter.SetCancellationToken(&cancellation);
+
+	try
+	{
+		return InterpretProgramAndReport(interpreter, program, printStats, statsPath);
+	}
+	catch (const CancelledException&)
+	{
+		// The standard output was closed, which ends the program like a broken pipe
+		return EXIT_SUCCESS;
+	}
+	catch (...)
+	{
+		// Nothing may be unwound once the exception leaves, so the output is written first
+		io.Finish();
+		throw;
+	}
+}
+
+// Interprets a file, saving checkpoints to resume it from
+int InterpretCheckpointed(const std::string& filename, const std::string& checkpointPath, std::uint64_t intervalSeconds, bool resume)
+{
+	std::vector<char> program;
+	if (!ReadFile(filename, program))
+		return EXIT_FAILURE;
+
+	return CheckpointedRun::Run(program, checkpointPath, intervalSeconds, resume);
+}
+
+// Interprets every file on its own thread, piping each file's output to the next file's input
+int InterpretPipeline(const std::vector<std::string>& filenames)
+{
+	std::vector<std::vector<char>> programs(filenames.size());
+	for (std::size_t i = 0; i < filenames.size(); i++)
+	{
+		if (!ReadFile(filenames[i], programs[i]))
+			return EXIT_FAILURE;
+	}
+
+	return Pipeline::Run(programs.size(), [&](std::size_t index, std::istream& input, std::ostream& output, std::ostream& error, const CancellationToken& cancellation)
+	{
+		Emmental interpreter(input, output, error);
+		interpreter.SetCancellationToken(&cancellation);
+		const std::vector<char>& program = programs[index];
+
+		int result = EXIT_SUCCESS;
+
+		try
+		{
+			if (Quota::IsLimited())
+			{
+				if (!Quota::Interpret(interpreter, program.data(), program.size()))
+					result = Quota::ExitCode;
+			}
+			else
+				InterpretRange(interpreter, program, 0, program.size());
+		}
+		catch (const CancelledException&)
+		{
+			// The next stage stopped reading, which ends this one like a broken pipe
+		}
+		catch (const EmmentalException&)
+		{
+			result = EXIT_FAILURE;
+		}
+
+		interpreter.SummarizeDiagnostics();
+		return result;
+	});
+}
+
+// Interprets a file once per input file, sharing the program prepared once between the workers
+int InterpretBatch(const std::string& filename, const std::vector<std::string>& inputs, unsigned int workerCount)
+{
+	std::vector<char> program;
+	if (!ReadFile(filename, program))
+		return EXIT_FAILURE;
+
+	// The whole run counts towards the quotas, so the prefix is left to every run when they're selected
+	ProgramImage image(std::move(program), !Quota::IsLimited());
+	return Batch::Run(image, inputs, workerCount);
+}
+
+int ServeRequests(const std::string& socketPath, const std::string& preludeFilename)
+{
+	std::vector<char> prelude;
+	if (!preludeFilename.empty() && !ReadFile(preludeFilename, prelude))
+		return EXIT_FAILURE;
+
+	return ForkServer::Serve(socketPath, prelude);
+}
+
+int SubmitFile(const std::string& socketPath, const std::string& filename)
+{
+	std::vector<char> program;
+	if (!ReadFile(filename, program))
+		return EXIT_FAILURE;
+
+	std::string input(std::istreambuf_iterator<char>(std::cin), {});
+	return ForkServer::Submit(socketPath, program, input, std::cout, std::cerr);
+}
+
 int Start(std::vector<std::string>& args)
 {
 	Globals::Initialize();
 
+	// A pipeline is given as files separated by '|' arguments. The first file is parsed as usual, the following ones are split off here.
+	std::vector<std::string> pipeline;
+	auto separator = std::find(args.begin(), args.end(), "|");
+
+	for (auto arg = separator; arg != args.end(); arg += 2)
+	{
+		if (*arg != "|" || arg + 1 == args.end())
+		{
+			std::cerr << "Error: Pipelines must be given as files separated by '|' arguments, after all options." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		pipeline.push_back(*(arg + 1));
+
+		if (arg + 2 == args.end())
+			break;
+	}
+
+	args.erase(separator, args.end());
+
 	try
 	{
 		TCLAP::CmdLine cmd("Gory Emmental is a C++ interpreter for the esoteric language Emmental.", '=', "1.0.0");
@@ -79,10 +362,60 @@ int Start(std::vector<std::string>& args)
 		TCLAP::SwitchArg quietArg("q", "quiet", "Only prints program output.", cmd, Globals::QuietMode);
 		TCLAP::SwitchArg lenientArg("l", "lenient", "Treats execution errors as warnings and uses non-standard interpreter behavior to continue program execution.", 
 			cmd, Globals::LenientMode);
+		TCLAP::ValueArg<std::string> cacheArg("", "cache",
+			"Caches the interpreter state after the input-independent prefix of a file in the given directory, and resumes from it on later runs.",
+			false, "", "directory", cmd);
+		TCLAP::ValueArg<std::string> preludeArg("", "prelude", "File executed once by the server before it starts serving requests.", false, "", "file", cmd);
+		TCLAP::ValueArg<std::string> connectArg("", "connect",
+			"Runs the file on the server listening on the given socket, using this program's input, instead of interpreting it locally.",
+			false, "", "socket", cmd);
+
+		std::vector<unsigned int> cellWidths = { 8, 16, 32, 64 };
+		TCLAP::ValuesConstraint<unsigned int> cellWidthConstraint(cellWidths);
+		TCLAP::ValueArg<unsigned int> cellWidthArg("b", "bits",
+			"Width of stack and queue cells in bits. Widths other than 8 are non-standard. Input and output are still one byte per symbol.",
+			false, Globals::CellWidth, &cellWidthConstraint, cmd);
+		TCLAP::MultiArg<std::string> batchArg("", "batch",
+			"Runs the file once per given input file instead of the standard input, writing each run's output to the input's path with .out appended.",
+			false, "file", cmd);
+		TCLAP::ValueArg<unsigned int> workersArg("", "workers", "Number of threads running the --batch inputs. Defaults to the number of processors.",
+			false, std::max(std::thread::hardware_concurrency(), 1u), "count", cmd);
+		TCLAP::SwitchArg ioThreadsArg("", "io-threads",
+			"Reads the standard input ahead and writes the standard output on background threads, so slow or bursty pipes don't stall the program.", cmd, false);
+		TCLAP::ValueArg<std::uint64_t> checkpointEveryArg("", "checkpoint-every",
+			"Saves a checkpoint of the run at the given interval, so it can be continued with --resume after a crash. Defaults to 60 with --checkpoint or --resume.",
+			false, 60, "seconds", cmd);
+		TCLAP::ValueArg<std::string> checkpointArg("", "checkpoint", "Path of the checkpoint file. Defaults to the file's path with .checkpoint appended.",
+			false, "", "path", cmd);
+		TCLAP::SwitchArg resumeArg("", "resume", "Continues the run from its checkpoint if there is one, and saves checkpoints of it.", cmd, false);
+		TCLAP::SwitchArg statsArg("", "stats",
+			"Prints statistics of the run to the standard error once it stops: symbols executed, supplants, definition memory, peak depths and speed.", cmd, false);
+		TCLAP::ValueArg<std::string> statsJsonArg("", "stats-json", "Writes the statistics of the run to the given file as a JSON object once it stops.",
+			false, "", "file", cmd);
+		TCLAP::ValueArg<std::uint64_t> diagnosticLimitArg("", "diagnostic-limit",
+			"Prints each distinct warning or error at most the given number of times, then only counts its repeats and summarizes them once the run stops. "
+			"0 prints every one. Defaults to no limit in interactive mode.",
+			false, 10, "count", cmd);
+		TCLAP::SwitchArg detectCyclesArg("", "detect-cycles",
+			"Stops a definition that calls itself again with exactly the same state, as that recursion can never end. With -l, it's only reported.", cmd, Globals::DetectCycles);
+		TCLAP::ValueArg<std::uint64_t> stackSizeArg("", "stack-size", "Maximum number of symbols on the stack. Sizes other than 1000 are non-standard.",
+			false, Globals::MaxStackSize, "symbols", cmd);
+		TCLAP::ValueArg<std::uint64_t> queueSizeArg("", "queue-size", "Maximum number of symbols in the queue. Sizes other than 1000 are non-standard.",
+			false, Globals::MaxQueueSize, "symbols", cmd);
+		TCLAP::ValueArg<std::string> spillArg("", "spill",
+			"Keeps the parts of a large stack or queue that aren't near either end in scratch files in the given directory, instead of in memory.",
+			false, "", "directory", cmd);
+		TCLAP::ValueArg<std::uint64_t> maxStepsArg("", "max-steps", "Stops the program after executing the given number of symbols.", false, 0, "count", cmd);
+		TCLAP::ValueArg<std::uint64_t> maxTimeArg("", "max-time", "Stops the program after running for the given wall-clock time.", false, 0, "milliseconds", cmd);
+		TCLAP::ValueArg<std::uint64_t> maxMemoryArg("", "max-memory", "Stops the program once its definitions hold more than the given memory.", false, 0, "bytes", cmd);
 
 		TCLAP::SwitchArg interactiveModeArg("i", "interactive", "Uses interactive mode.", false);
+		TCLAP::ValueArg<std::string> serveArg("", "serve",
+			"Runs a server on the given Unix domain socket, serving each request from a forked copy of an interpreter prepared with --prelude.",
+			true, "", "socket");
 		TCLAP::UnlabeledValueArg<std::string> inputFileArg("Input", "The Emmental code file to interpret.", true, "", "file", false);
-		cmd.xorAdd(interactiveModeArg, inputFileArg);
+		std::vector<TCLAP::Arg*> modeArgs = { &interactiveModeArg, &serveArg, &inputFileArg };
+		cmd.xorAdd(modeArgs);
 
 		cmd.parse(args);
 		Globals::DebugMode = debugModeArg.getValue();
@@ -91,6 +424,56 @@ int Start(std::vector<std::string>& args)
 		Globals::IgnoreWhitespace = ignoreWhitespaceArg.getValue();
 		Globals::QuietMode = quietArg.getValue();
 		Globals::LenientMode = lenientArg.getValue();
+		Globals::CacheDirectory = cacheArg.getValue();
+		Globals::CellWidth = cellWidthArg.getValue();
+		Globals::MaxSteps = maxStepsArg.getValue();
+		Globals::MaxMilliseconds = maxTimeArg.getValue();
+		Globals::MaxDefinitionBytes = maxMemoryArg.getValue();
+		Globals::DetectCycles = detectCyclesArg.getValue();
+		Globals::SpillDirectory = spillArg.getValue();
+		Globals::CollectStats = statsArg.isSet() || statsJsonArg.isSet();
+		// Every command of an interactive session is looked at as it runs, so nothing is held back unless asked for
+		Globals::DiagnosticLimit = interactiveModeArg.isSet() && !diagnosticLimitArg.isSet() ? 0 : diagnosticLimitArg.getValue();
+
+		if (stackSizeArg.getValue() > PTRDIFF_MAX || queueSizeArg.getValue() > PTRDIFF_MAX)
+		{
+			std::cerr << "Error: The stack and queue sizes must be at most " << PTRDIFF_MAX << " symbols." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		Globals::MaxStackSize = (std::size_t)stackSizeArg.getValue();
+		Globals::MaxQueueSize = (std::size_t)queueSizeArg.getValue();
+
+		if (spillArg.isSet())
+		{
+			// Scratch files are shared by forked processes, so a served interpreter can't spill
+			if (serveArg.isSet() || !ScratchFile::Create(Globals::SpillDirectory, 1))
+			{
+				std::cerr << "Error: Can't spill to '" << Globals::SpillDirectory << "'. Spilling needs a writable directory on a POSIX system, and can't be used by a server." << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		if (ioThreadsArg.isSet() && (!inputFileArg.isSet() || connectArg.isSet() || batchArg.isSet() || !pipeline.empty() || Globals::DebugMode))
+		{
+			std::cerr << "Error: I/O threads can only be used to interpret a single file locally, without debug mode." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		bool checkpointed = checkpointEveryArg.isSet() || checkpointArg.isSet() || resumeArg.isSet();
+		if (checkpointed && (!inputFileArg.isSet() || connectArg.isSet() || batchArg.isSet() || !pipeline.empty() || ioThreadsArg.isSet()
+			|| Globals::DebugMode || Globals::DetectCycles || Quota::IsLimited() || !Globals::CacheDirectory.empty() || checkpointEveryArg.getValue() == 0))
+		{
+			std::cerr << "Error: Checkpoints can only be saved by a single file interpreted locally, at an interval of at least a second, "
+				"without I/O threads, debug mode, cycle detection, quotas or a cache." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (Globals::CollectStats && (!inputFileArg.isSet() || connectArg.isSet() || batchArg.isSet() || !pipeline.empty() || checkpointed || Globals::DebugMode))
+		{
+			std::cerr << "Error: Statistics can only be collected while interpreting a single file locally, without checkpoints or debug mode." << std::endl;
+			return EXIT_FAILURE;
+		}
 
 		if (interactiveModeArg.isSet())
 		{
@@ -99,7 +482,42 @@ int Start(std::vector<std::string>& args)
 			return interactive.RunLoop();
 		}
 
-		return InterpretFile(inputFileArg.getValue());
+		if (serveArg.isSet())
+			return ServeRequests(serveArg.getValue(), preludeArg.getValue());
+
+		if (!pipeline.empty())
+		{
+			if (!inputFileArg.isSet() || connectArg.isSet() || batchArg.isSet())
+			{
+				std::cerr << "Error: Pipelines can only be used to interpret files locally." << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			pipeline.insert(pipeline.begin(), inputFileArg.getValue());
+			return InterpretPipeline(pipeline);
+		}
+
+		if (batchArg.isSet())
+		{
+			if (!inputFileArg.isSet() || connectArg.isSet() || Globals::DebugMode || workersArg.getValue() == 0)
+			{
+				std::cerr << "Error: Batches can only be used to interpret files locally, without debug mode, on at least one worker." << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			return InterpretBatch(inputFileArg.getValue(), batchArg.getValue(), workersArg.getValue());
+		}
+
+		if (connectArg.isSet())
+			return SubmitFile(connectArg.getValue(), inputFileArg.getValue());
+
+		if (checkpointed)
+		{
+			std::string checkpointPath = checkpointArg.isSet() ? checkpointArg.getValue() : inputFileArg.getValue() + ".checkpoint";
+			return InterpretCheckpointed(inputFileArg.getValue(), checkpointPath, checkpointEveryArg.getValue(), resumeArg.getValue());
+		}
+
+		return InterpretFile(inputFileArg.getValue(), ioThreadsArg.getValue(), statsArg.getValue(), statsJsonArg.getValue());
 	}
 	catch (TCLAP::ArgException& e)
 	{
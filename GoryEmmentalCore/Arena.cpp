@@ -0,0 +1,94 @@
+#include "Arena.h"
+
+ArenaGeneration::ArenaGeneration(std::shared_ptr<std::size_t> usage) : Usage(std::move(usage))
+{
+}
+
+ArenaGeneration::~ArenaGeneration()
+{
+	*Usage -= AllocatedBytes;
+}
+
+void* ArenaGeneration::Allocate(std::size_t size, std::size_t alignment)
+{
+	if (size == 0 || size > MaxRecycledSize)
+	{
+		AllocatedBytes += size;
+		*Usage += size;
+		return AllocateFromChunks(size, alignment);
+	}
+
+	std::size_t sizeClass = (size - 1) / Granularity;
+	FreeBlock* block = FreeLists[sizeClass];
+	AllocatedBytes += (sizeClass + 1) * Granularity;
+	*Usage += (sizeClass + 1) * Granularity;
+
+	if (block && alignment <= Granularity)
+	{
+		FreeLists[sizeClass] = block->Next;
+		return block;
+	}
+
+	return AllocateFromChunks((sizeClass + 1) * Granularity, alignment > Granularity ? alignment : Granularity);
+}
+
+void ArenaGeneration::Deallocate(void* pointer, std::size_t size)
+{
+	// Same classification as Allocate(), only called with the sizes allocations were made with
+	if (size == 0 || size > MaxRecycledSize)
+	{
+		AllocatedBytes -= size;
+		*Usage -= size;
+		return;
+	}
+
+	std::size_t sizeClass = (size - 1) / Granularity;
+	FreeBlock* block = static_cast<FreeBlock*>(pointer);
+
+	block->Next = FreeLists[sizeClass];
+	FreeLists[sizeClass] = block;
+	AllocatedBytes -= (sizeClass + 1) * Granularity;
+	*Usage -= (sizeClass + 1) * Granularity;
+}
+
+void* ArenaGeneration::AllocateFromChunks(std::size_t size, std::size_t alignment)
+{
+	while (CurrentChunk < Chunks.size())
+	{
+		std::size_t start = (Position + alignment - 1) / alignment * alignment;
+
+		if (start + size <= ChunkSizes[CurrentChunk])
+		{
+			Position = start + size;
+			return Chunks[CurrentChunk].get() + start;
+		}
+
+		CurrentChunk++;
+		Position = 0;
+	}
+
+	// Chunks come from new[], so they are aligned for any fundamental type
+	std::size_t chunkSize = size > ChunkSize ? size : ChunkSize;
+	Chunks.emplace_back(new char[chunkSize]);
+	ChunkSizes.push_back(chunkSize);
+	ReservedBytes += chunkSize;
+	CurrentChunk = Chunks.size() - 1;
+	Position = size;
+
+	return Chunks.back().get();
+}
+
+void ArenaGeneration::Rewind()
+{
+	for (auto& list : FreeLists)
+		list = nullptr;
+
+	CurrentChunk = 0;
+	Position = 0;
+	*Usage -= AllocatedBytes;
+	AllocatedBytes = 0;
+}
+
+std::size_t ArenaGeneration::GetAllocatedBytes() const { return AllocatedBytes; }
+
+std::size_t ArenaGeneration::GetReservedBytes() const { return ReservedBytes; }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <type_traits>
+
+// Bump allocator for definitions and their data.
+// Small freed blocks are recycled through per-size free lists, everything else is only released when the whole generation is,
+// at once, when the last allocator referencing it is destroyed.
+class ArenaGeneration
+{
+public:
+	// Live allocations are also counted in usage, which generations can share to count their memory together
+	explicit ArenaGeneration(std::shared_ptr<std::size_t> usage = std::make_shared<std::size_t>(0));
+	~ArenaGeneration();
+	ArenaGeneration(const ArenaGeneration&) = delete;
+	ArenaGeneration& operator=(const ArenaGeneration&) = delete;
+
+	void* Allocate(std::size_t size, std::size_t alignment);
+	void Deallocate(void* pointer, std::size_t size);
+	// Makes all memory available again, keeping the chunks. Only valid when nothing allocated from this generation is alive.
+	void Rewind();
+	// Gets the number of bytes held by live allocations
+	std::size_t GetAllocatedBytes() const;
+	// Gets the number of bytes held by the generation, live or not
+	std::size_t GetReservedBytes() const;
+
+private:
+	static const std::size_t ChunkSize = 64 * 1024;
+	// Blocks up to this size are rounded up to a multiple of Granularity and recycled
+	static const std::size_t MaxRecycledSize = 1024;
+	static const std::size_t Granularity = 16;
+
+	struct FreeBlock { FreeBlock* Next; };
+	FreeBlock* FreeLists[MaxRecycledSize / Granularity] = {};
+
+	void* AllocateFromChunks(std::size_t size, std::size_t alignment);
+
+	std::vector<std::unique_ptr<char[]>> Chunks;
+	std::vector<std::size_t> ChunkSizes;
+	std::size_t CurrentChunk = 0;
+	std::size_t Position = 0;
+	std::size_t AllocatedBytes = 0;
+	std::size_t ReservedBytes = 0;
+	std::shared_ptr<std::size_t> Usage;
+};
+
+// Standard allocator over an arena generation. Every allocator keeps its generation alive.
+template<typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(std::shared_ptr<ArenaGeneration> generation) : Generation(std::move(generation)) {}
+	template<typename U> ArenaAllocator(const ArenaAllocator<U>& other) : Generation(other.Generation) {}
+
+	T* allocate(std::size_t count) { return static_cast<T*>(Generation->Allocate(count * sizeof(T), alignof(T))); }
+	void deallocate(T* pointer, std::size_t count) { Generation->Deallocate(pointer, count * sizeof(T)); }
+
+	template<typename U> bool operator==(const ArenaAllocator<U>& other) const { return Generation == other.Generation; }
+	template<typename U> bool operator!=(const ArenaAllocator<U>& other) const { return Generation != other.Generation; }
+
+	ArenaGeneration* GetGeneration() const { return Generation.get(); }
+
+private:
+	template<typename U> friend class ArenaAllocator;
+	std::shared_ptr<ArenaGeneration> Generation;
+};
+
+// Array with a capacity fixed at construction. Up to InlineSize items are stored inside the array itself, larger arrays in an arena.
+// The array doesn't keep the arena generation alive: it must be a member of an object allocated with an ArenaAllocator of the same generation.
+template<typename T, std::size_t InlineSize>
+class ArenaArray
+{
+public:
+	template<typename U>
+	ArenaArray(std::size_t capacity, const ArenaAllocator<U>& allocator)
+		: Generation(allocator.GetGeneration()), Capacity(capacity), Count(0)
+	{
+		Items = capacity <= InlineSize ? reinterpret_cast<T*>(&Inline) : static_cast<T*>(Generation->Allocate(capacity * sizeof(T), alignof(T)));
+	}
+
+	~ArenaArray()
+	{
+		for (std::size_t i = 0; i < Count; i++)
+			Items[i].~T();
+
+		if (Capacity > InlineSize)
+			Generation->Deallocate(Items, Capacity * sizeof(T));
+	}
+
+	ArenaArray(const ArenaArray&) = delete;
+	ArenaArray& operator=(const ArenaArray&) = delete;
+
+	// Adds an item at the end. The array must not be full.
+	void PushBack(const T& item) { new (&Items[Count++]) T(item); }
+
+	std::size_t size() const { return Count; }
+	std::size_t capacity() const { return Capacity; }
+	bool empty() const { return Count == 0; }
+	T& operator[](std::size_t index) { return Items[index]; }
+	const T& operator[](std::size_t index) const { return Items[index]; }
+	T* begin() { return Items; }
+	T* end() { return Items + Count; }
+	const T* begin() const { return Items; }
+	const T* end() const { return Items + Count; }
+
+private:
+	ArenaGeneration* Generation;
+	std::size_t Capacity;
+	std::size_t Count;
+	T* Items;
+	typename std::aligned_storage<sizeof(T) * (InlineSize > 0 ? InlineSize : 1), alignof(T)>::type Inline;
+};
\ No newline at end of file
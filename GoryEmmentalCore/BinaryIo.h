@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+// Integers stored in files, in little-endian order regardless of the system
+namespace BinaryIo
+{
+	template<typename T>
+	void Write(std::ostream& output, T value)
+	{
+		for (std::size_t i = 0; i < sizeof(T); i++)
+			output.put((char)(unsigned char)((std::uint64_t)value >> (i * 8)));
+	}
+
+	template<typename T>
+	bool Read(std::istream& input, T& value)
+	{
+		std::uint64_t result = 0;
+		for (std::size_t i = 0; i < sizeof(T); i++)
+		{
+			int byte = input.get();
+			if (byte == std::char_traits<char>::eof())
+				return false;
+
+			result |= (std::uint64_t)(unsigned char)byte << (i * 8);
+		}
+
+		value = (T)result;
+		return true;
+	}
+
+	// Checks that count items of itemBytes each fit between the position of a stream and the end of its data at size.
+	// Counts read from a damaged file are checked with this before anything is allocated for them.
+	inline bool Fits(std::istream& input, std::uint64_t size, std::uint64_t count, std::uint64_t itemBytes)
+	{
+		std::streamoff position = input.tellg();
+		return position >= 0 && (std::uint64_t)position <= size && count <= (size - (std::uint64_t)position) / itemBytes;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include <atomic>
+
+// Asks an interpreter to stop executing. Can be cancelled from any thread, or from a signal handler.
+class CancellationToken
+{
+public:
+	void Cancel() { Cancelled.store(true, std::memory_order_relaxed); }
+	void Reset() { Cancelled.store(false, std::memory_order_relaxed); }
+	bool IsCancelled() const { return Cancelled.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<bool> Cancelled{ false };
+};
\ No newline at end of file
@@ -0,0 +1,507 @@
+#include "Checkpoint.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "NativeDefinition.h"
+#include "InterpretedDefinition.h"
+#include "DefinitionGraph.h"
+#include "SymbolDeque.h"
+#include "BinaryIo.h"
+#include "FileReplacement.h"
+
+#if _WIN32
+#	include <io.h>
+#else
+#	include <unistd.h>
+#endif
+
+using BinaryIo::Write;
+using BinaryIo::Read;
+using BinaryIo::Fits;
+
+// Bump whenever the file layout or the interpreter semantics change, so old checkpoints aren't resumed
+static const std::uint32_t CheckpointVersion = 2;
+static const char CheckpointMagic[4] = { 'G', 'E', 'M', 'K' };
+
+enum class RecordKind : std::uint8_t { Native = 0, Interpreted = 1, Segment = 2 };
+
+// Segments are stored as they are in memory, as a checkpoint is only resumed on the system that wrote it, with the same cell width
+static const std::size_t SegmentBytes = SymbolDeque::SegmentBytes;
+
+// The log is compacted once the records no longer used take more than this, and more than the records still used
+static const std::uint64_t CompactionThreshold = 16 * 1024 * 1024;
+
+// Makes sure everything written to a file is on the disk, so a checkpoint never refers to data lost in a crash
+static bool SyncFile(std::FILE* file)
+{
+	if (std::fflush(file) != 0)
+		return false;
+
+#if _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Reads the header of a checkpoint, up to the stream offsets
+static bool ReadHeader(std::istream& state, std::uint64_t& key, std::uint64_t& generation, std::uint64_t& logSize)
+{
+	char magic[sizeof(CheckpointMagic)];
+	std::uint32_t version;
+
+	if (!state.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), CheckpointMagic))
+		return false;
+	if (!Read(state, version) || version != CheckpointVersion)
+		return false;
+
+	return Read(state, key) && Read(state, generation) && Read(state, logSize);
+}
+
+// Appends the full segments of a sequence that aren't in the log yet to the records, and writes the layout of the sequence to the state
+static void WriteSequence(std::ostream& state, std::ostream& records, std::uint64_t recordsOffset, const SymbolDeque& sequence,
+	std::unordered_map<std::uint64_t, std::uint64_t>& written, std::uint64_t& liveBytes)
+{
+	std::unordered_map<std::uint64_t, std::uint64_t> current;
+	std::size_t fullSegments = sequence.GetSegmentCount() - 1;
+
+	Write<std::uint64_t>(state, sequence.Size());
+	Write<std::uint64_t>(state, sequence.GetHead());
+	Write<std::uint64_t>(state, fullSegments);
+
+	for (std::size_t i = 0; i < fullSegments; i++)
+	{
+		std::uint64_t serial = sequence.GetSegmentSerial(i);
+		auto found = written.find(serial);
+		std::uint64_t offset;
+
+		if (found != written.end())
+		{
+			offset = found->second;
+		}
+		else
+		{
+			offset = recordsOffset + (std::uint64_t)records.tellp();
+			Write(records, (std::uint8_t)RecordKind::Segment);
+			records.write(reinterpret_cast<const char*>(sequence.GetSegment(i)), SegmentBytes);
+		}
+
+		current[serial] = offset;
+		liveBytes += 1 + SegmentBytes;
+		Write(state, offset);
+	}
+
+	// The back segment changes all the time, so it's stored in the state
+	const unsigned char* back = sequence.GetSegment(fullSegments);
+	Write<std::uint64_t>(state, sequence.GetTail());
+	for (std::size_t i = 0; i < sequence.GetTail(); i++)
+		Write(state, sequence.Load(back, i));
+
+	written.swap(current);
+}
+
+// Reads a sequence written from a sequence with the same cell width as layout
+static bool ReadSequence(std::istream& state, std::istream& log, std::uint64_t logSize, const SymbolDeque& layout, std::vector<SymbolT>& symbols)
+{
+	std::uint64_t count;
+	std::uint64_t head;
+	std::uint64_t fullSegments;
+	std::uint64_t tail;
+
+	if (!Read(state, count) || !Read(state, head) || !Read(state, fullSegments))
+		return false;
+	std::size_t segmentSize = layout.GetSegmentSize();
+	if (head > segmentSize || fullSegments > count / segmentSize + 1)
+		return false;
+
+	std::vector<unsigned char> segment(SegmentBytes);
+	for (std::uint64_t i = 0; i < fullSegments; i++)
+	{
+		std::uint64_t offset;
+		std::uint8_t kind;
+
+		if (!Read(state, offset) || offset > logSize || logSize - offset < 1 + SegmentBytes)
+			return false;
+
+		log.seekg((std::streamoff)offset);
+		if (!Read(log, kind) || kind != (std::uint8_t)RecordKind::Segment || !log.read(reinterpret_cast<char*>(segment.data()), SegmentBytes))
+			return false;
+
+		for (std::size_t j = (i == 0 ? (std::size_t)head : 0); j < segmentSize; j++)
+			symbols.push_back(layout.Load(segment.data(), j));
+	}
+
+	if (!Read(state, tail) || tail > segmentSize)
+		return false;
+
+	for (std::uint64_t i = 0; i < tail; i++)
+	{
+		SymbolT symbol;
+		if (!Read(state, symbol))
+			return false;
+
+		// Without full segments, the back segment is also the front one
+		if (fullSegments > 0 || i >= head)
+			symbols.push_back(symbol);
+	}
+
+	return symbols.size() == count;
+}
+
+Checkpoint::Checkpoint(const std::string& path, std::uint64_t key) : Path(path), Key(key)
+{
+	// New logs are numbered after the log of a stored checkpoint, which is only deleted once it's replaced
+	std::ifstream state(Path, std::ios_base::binary | std::ios_base::in);
+	std::uint64_t storedKey;
+	std::uint64_t logSize;
+
+	if (state && ReadHeader(state, storedKey, StoredGeneration, logSize))
+		Generation = StoredGeneration;
+	else
+		StoredGeneration = 0;
+}
+
+Checkpoint::~Checkpoint()
+{
+	if (Log)
+		std::fclose(Log);
+}
+
+bool Checkpoint::Exists() const
+{
+	return StoredGeneration != 0;
+}
+
+bool Checkpoint::Load(Emmental& interpreter, ExecutionTask& task, StreamOffsets& offsets)
+{
+	std::ifstream state(Path, std::ios_base::binary | std::ios_base::in);
+	std::uint64_t storedKey;
+	std::uint64_t generation;
+	std::uint64_t logSize;
+
+	if (!state || !ReadHeader(state, storedKey, generation, logSize) || storedKey != Key)
+		return false;
+	if (!Read(state, offsets.Input) || !Read(state, offsets.Output))
+		return false;
+
+	std::ifstream log(GetLogPath(generation), std::ios_base::binary | std::ios_base::in);
+	if (!log)
+		return false;
+
+	// Captures are always written before the definitions capturing them, so reading the log in order creates them first.
+	// Natives are stored by their original symbol, and are taken from the interpreter's default definitions.
+	interpreter.Reset();
+	SymbolMapT defaults = interpreter.CopyDefinitions();
+	std::unordered_map<std::uint64_t, std::shared_ptr<EmmentalDefinition>> nodes;
+	std::uint64_t position = 0;
+
+	while (position < logSize)
+	{
+		std::uint8_t kind;
+		if (!Read(log, kind))
+			return false;
+
+		if (kind == (std::uint8_t)RecordKind::Native)
+		{
+			SymbolT symbol;
+			if (!Read(log, symbol) || defaults.find(symbol) == defaults.end())
+				return false;
+
+			nodes[position] = defaults[symbol];
+		}
+		else if (kind == (std::uint8_t)RecordKind::Interpreted)
+		{
+			std::uint32_t length;
+			std::uint32_t count;
+
+			if (!Read(log, length) || !Fits(log, logSize, length, sizeof(SymbolT)))
+				return false;
+
+			ProgramT program(length);
+			for (auto& symbol : program)
+				if (!Read(log, symbol)) return false;
+
+			SymbolMapT captured;
+			if (!Read(log, count) || !Fits(log, logSize, count, sizeof(SymbolT) + sizeof(std::uint64_t)))
+				return false;
+
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				SymbolT symbol;
+				std::uint64_t offset;
+
+				if (!Read(log, symbol) || !Read(log, offset) || nodes.find(offset) == nodes.end())
+					return false;
+
+				captured[symbol] = nodes[offset];
+			}
+
+			nodes[position] = interpreter.CreateDefinition(program, captured);
+		}
+		else if (kind == (std::uint8_t)RecordKind::Segment)
+		{
+			if (!log.seekg(SegmentBytes, std::ios_base::cur))
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+
+		std::streamoff next = log.tellg();
+		if (next < 0)
+			return false;
+
+		position = (std::uint64_t)next;
+	}
+
+	ExecutionTask::Progress progress;
+	std::uint64_t taskPosition;
+	std::uint8_t hasPendingEval;
+	std::uint64_t pendingEvalLevel;
+	std::uint32_t count;
+
+	if (!Read(state, taskPosition) || !Read(state, progress.StepCount) || !Read(state, hasPendingEval) || !Read(state, progress.PendingEval)
+		|| !Read(state, pendingEvalLevel) || !Read(state, count))
+		return false;
+
+	progress.Position = (std::size_t)taskPosition;
+	progress.HasPendingEval = hasPendingEval != 0;
+	progress.PendingEvalLevel = (std::size_t)pendingEvalLevel;
+
+	for (std::uint32_t i = 0; i < count; i++)
+	{
+		std::uint64_t offset;
+		std::uint64_t callPosition;
+		std::uint64_t recursionLevel;
+
+		if (!Read(state, offset) || !Read(state, callPosition) || !Read(state, recursionLevel))
+			return false;
+
+		auto node = nodes.find(offset);
+		if (node == nodes.end() || !node->second->AsInterpreted() || callPosition > node->second->AsInterpreted()->GetProgramSize())
+			return false;
+
+		progress.Calls.push_back({ node->second, (std::size_t)callPosition, (std::size_t)recursionLevel });
+	}
+
+	SymbolMapT definitions;
+	if (!Read(state, count))
+		return false;
+
+	for (std::uint32_t i = 0; i < count; i++)
+	{
+		SymbolT symbol;
+		std::uint64_t offset;
+
+		if (!Read(state, symbol) || !Read(state, offset) || nodes.find(offset) == nodes.end())
+			return false;
+
+		definitions[symbol] = nodes[offset];
+	}
+
+	std::vector<SymbolT> stack;
+	std::vector<SymbolT> queue;
+	if (!ReadSequence(state, log, logSize, interpreter.GetStackStorage(), stack)
+		|| !ReadSequence(state, log, logSize, interpreter.GetQueueStorage(), queue))
+		return false;
+
+	interpreter.SetDefinitions(definitions);
+	for (SymbolT symbol : stack)
+		interpreter.Push(symbol);
+	for (SymbolT symbol : queue)
+		interpreter.Enqueue(symbol);
+	task.SetProgress(progress);
+
+	// The next checkpoint starts a new log, after the log of this one
+	StoredGeneration = generation;
+	Generation = std::max(Generation, generation);
+	if (Log)
+		std::fclose(Log);
+	Log = nullptr;
+
+	return true;
+}
+
+bool Checkpoint::Save(const Emmental& interpreter, const ExecutionTask& task, const StreamOffsets& offsets)
+{
+	// Once the records no longer used take most of the log, the checkpoint is written in full to a new one
+	std::uint64_t deadBytes = LogSize - LiveBytes;
+	if (!Log || (deadBytes > CompactionThreshold && deadBytes > LiveBytes))
+	{
+		if (!StartLog())
+			return false;
+	}
+
+	std::ostringstream records;
+	std::ostringstream body;
+	std::uint64_t liveBytes = 0;
+
+	ExecutionTask::Progress progress = task.GetProgress();
+	SymbolMapT definitions = interpreter.CopyDefinitions();
+
+	// Calls may execute definitions that were replaced since they started, which have to be written too
+	SymbolMapT called;
+	for (std::size_t i = 0; i < progress.Calls.size(); i++)
+		called[i] = progress.Calls[i].Definition;
+
+	std::unordered_map<const EmmentalDefinition*, WrittenDefinition> current;
+	for (const SymbolMapT* roots : { &definitions, &called })
+	{
+		for (auto& node : DefinitionGraph::Collect(*roots))
+		{
+			if (current.find(node.get()) != current.end())
+				continue;
+
+			auto found = Definitions.find(node.get());
+			WrittenDefinition record;
+
+			if (found != Definitions.end())
+			{
+				record = found->second;
+			}
+			else
+			{
+				std::uint64_t start = (std::uint64_t)records.tellp();
+				const InterpretedDefinition* interpreted = node->AsInterpreted();
+
+				if (interpreted)
+				{
+					ProgramT program = interpreted->GetProgram();
+					SymbolMapT captured = interpreted->GetDefinitions();
+
+					Write(records, (std::uint8_t)RecordKind::Interpreted);
+					Write<std::uint32_t>(records, (std::uint32_t)program.size());
+					for (SymbolT symbol : program)
+						Write(records, symbol);
+
+					Write<std::uint32_t>(records, (std::uint32_t)captured.size());
+					for (auto& pair : captured)
+					{
+						Write(records, pair.first);
+						Write(records, current.at(pair.second.get()).Offset);
+					}
+				}
+				else
+				{
+					Write(records, (std::uint8_t)RecordKind::Native);
+					Write(records, node->AsNative()->GetSymbol());
+				}
+
+				record = { node, LogSize + start, (std::uint64_t)records.tellp() - start };
+			}
+
+			liveBytes += record.Size;
+			current[node.get()] = record;
+		}
+	}
+
+	Write<std::uint64_t>(body, progress.Position);
+	Write(body, progress.StepCount);
+	Write<std::uint8_t>(body, progress.HasPendingEval);
+	Write(body, progress.PendingEval);
+	Write<std::uint64_t>(body, progress.PendingEvalLevel);
+	Write<std::uint32_t>(body, (std::uint32_t)progress.Calls.size());
+	for (auto& call : progress.Calls)
+	{
+		Write(body, current.at(call.Definition.get()).Offset);
+		Write<std::uint64_t>(body, call.Position);
+		Write<std::uint64_t>(body, call.RecursionLevel);
+	}
+
+	Write<std::uint32_t>(body, (std::uint32_t)definitions.size());
+	for (auto& pair : definitions)
+	{
+		Write(body, pair.first);
+		Write(body, current.at(pair.second.get()).Offset);
+	}
+
+	WriteSequence(body, records, LogSize, interpreter.GetStackStorage(), StackSegments, liveBytes);
+	WriteSequence(body, records, LogSize, interpreter.GetQueueStorage(), QueueSegments, liveBytes);
+
+	// The records are on the disk before the state refers to them. A failed write leaves the log in an unknown state, so it's replaced next time.
+	std::string data = records.str();
+	if (std::fwrite(data.data(), 1, data.size(), Log) != data.size() || !SyncFile(Log))
+	{
+		std::fclose(Log);
+		Log = nullptr;
+		return false;
+	}
+
+	LogSize += data.size();
+	Definitions.swap(current);
+	LiveBytes = liveBytes;
+
+	std::ostringstream header;
+	header.write(CheckpointMagic, sizeof(CheckpointMagic));
+	Write(header, CheckpointVersion);
+	Write(header, Key);
+	Write(header, Generation);
+	Write(header, LogSize);
+	Write(header, offsets.Input);
+	Write(header, offsets.Output);
+
+	std::string temporaryPath = FileReplacement::CreateTemporary(Path);
+	if (temporaryPath.empty())
+		return false;
+
+	std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+	if (!file)
+	{
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	std::string contents = header.str() + body.str();
+	bool written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size() && SyncFile(file);
+	std::fclose(file);
+
+	if (!written || !FileReplacement::Replace(temporaryPath, Path))
+	{
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	// The previous log is no longer referred to once the state refers to a new one
+	if (StoredGeneration != 0 && StoredGeneration != Generation)
+		std::remove(GetLogPath(StoredGeneration).c_str());
+
+	StoredGeneration = Generation;
+	return true;
+}
+
+void Checkpoint::Remove()
+{
+	if (Log)
+		std::fclose(Log);
+	Log = nullptr;
+
+	std::remove(Path.c_str());
+	std::remove(GetLogPath(Generation).c_str());
+	if (StoredGeneration != 0)
+		std::remove(GetLogPath(StoredGeneration).c_str());
+
+	StoredGeneration = 0;
+}
+
+std::string Checkpoint::GetLogPath(std::uint64_t generation) const
+{
+	return Path + "." + std::to_string(generation);
+}
+
+bool Checkpoint::StartLog()
+{
+	if (Log)
+		std::fclose(Log);
+
+	Generation = std::max(Generation, StoredGeneration) + 1;
+	Log = std::fopen(GetLogPath(Generation).c_str(), "wb");
+	LogSize = 0;
+	LiveBytes = 0;
+	Definitions.clear();
+	StackSegments.clear();
+	QueueSegments.clear();
+
+	return Log != nullptr;
+}
\ No newline at end of file
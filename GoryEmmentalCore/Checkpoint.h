@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Emmental.h"
+#include "ExecutionTask.h"
+
+// Saves the state of a long run from time to time, so the run can be resumed after a crash.
+// Definitions and full segments of the stack and queue never change, so each of them is appended to a log once, and a checkpoint only
+// appends what appeared since the previous one. A checkpoint is complete once its state file, which refers to the log, replaces the previous one.
+class Checkpoint
+{
+public:
+	// Position of a run in its input and output, in bytes
+	struct StreamOffsets
+	{
+		std::uint64_t Input;
+		std::uint64_t Output;
+	};
+
+	// Checkpoints of a program with a key from StateCache::GetKey(), stored in the file at path and in logs next to it
+	Checkpoint(const std::string& path, std::uint64_t key);
+	~Checkpoint();
+
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+
+	// Checks if a checkpoint, of any program, is stored at the path
+	bool Exists() const;
+	// Restores the latest checkpoint into an interpreter and a task for the program that hasn't run yet.
+	// Returns false if it's missing, damaged or of another program.
+	bool Load(Emmental& interpreter, ExecutionTask& task, StreamOffsets& offsets);
+	// Writes a checkpoint of a task between runs. Returns false if it couldn't be written, the previous checkpoint is kept then.
+	bool Save(const Emmental& interpreter, const ExecutionTask& task, const StreamOffsets& offsets);
+	// Deletes the stored checkpoint, once its run is finished
+	void Remove();
+
+private:
+	// Definition written to the log, kept alive so its address isn't reused by another definition
+	struct WrittenDefinition
+	{
+		std::shared_ptr<EmmentalDefinition> Definition;
+		std::uint64_t Offset;
+		std::uint64_t Size;
+	};
+
+	std::string Path;
+	std::uint64_t Key;
+
+	// Log appended to, numbered so that a compacted log never replaces the one the stored checkpoint refers to
+	std::FILE* Log = nullptr;
+	std::uint64_t Generation = 0;
+	std::uint64_t LogSize = 0;
+	// Generation of the log the stored checkpoint refers to, 0 if none
+	std::uint64_t StoredGeneration = 0;
+
+	// Records of the log used by the last checkpoint, by definition and by segment serial, and their total size
+	std::unordered_map<const EmmentalDefinition*, WrittenDefinition> Definitions;
+	std::unordered_map<std::uint64_t, std::uint64_t> StackSegments;
+	std::unordered_map<std::uint64_t, std::uint64_t> QueueSegments;
+	std::uint64_t LiveBytes = 0;
+
+	std::string GetLogPath(std::uint64_t generation) const;
+	// Starts a new log, which the next checkpoint writes in full
+	bool StartLog();
+};
\ No newline at end of file
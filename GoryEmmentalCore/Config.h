@@ -0,0 +1,16 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+#define EMMENTAL_MAX_STACK_SIZE (1000)
+#define EMMENTAL_MAX_QUEUE_SIZE (1000)
+#define EMMENTAL_MAX_RECURSION_LEVEL (500)
+
+// Symbols are handled as values wide enough for every supported cell width, and are masked to the selected width when pushed.
+// The stack, the queue and definition bodies store them in cells no wider than needed, see SymbolCells.h.
+// Program text, input and output are always read and written as bytes.
+using SymbolT = std::uint64_t;
+using ProgramT = std::vector<SymbolT>;
+using SymbolMapT = std::map<SymbolT, std::shared_ptr<class EmmentalDefinition>>;
\ No newline at end of file
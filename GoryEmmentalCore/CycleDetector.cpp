@@ -0,0 +1,66 @@
+#include "CycleDetector.h"
+#include "EmmentalDefinition.h"
+
+// Inverse of an odd number modulo 2^64, by Newton's method: every iteration doubles the correct low bits
+static std::uint64_t Invert(std::uint64_t value)
+{
+	std::uint64_t inverse = value;
+	for (int i = 0; i < 5; i++)
+		inverse *= 2 - value * inverse;
+
+	return inverse;
+}
+
+const std::uint64_t CycleDetector::InverseBase = Invert(CycleDetector::Base);
+
+// Definitions are hashed by symbol, and summed so that one of them can be replaced in constant time
+static std::uint64_t HashEntry(SymbolT symbol, const EmmentalDefinition* definition)
+{
+	return definition ? CycleDetector::Mix(definition->GetContentHash(), symbol) : 0;
+}
+
+CycleDetector::CycleDetector()
+{
+	Executing.reserve(EMMENTAL_MAX_RECURSION_LEVEL);
+}
+
+void CycleDetector::StackCleared()
+{
+	StackHash = 0;
+	StackPower = 1;
+}
+
+void CycleDetector::QueueCleared()
+{
+	QueueHash = 0;
+	QueueHeadPower = 1;
+	QueueHeadInverse = 1;
+	QueueTailPower = 1;
+}
+
+void CycleDetector::Redefined(SymbolT symbol, const EmmentalDefinition* previous, const EmmentalDefinition* current)
+{
+	DefinitionsHash += HashEntry(symbol, current) - HashEntry(symbol, previous);
+}
+
+void CycleDetector::DefinitionsReplaced(const SymbolMapT& definitions)
+{
+	DefinitionsHash = 0;
+	for (auto& pair : definitions)
+		DefinitionsHash += HashEntry(pair.first, pair.second.get());
+}
+
+bool CycleDetector::Enter(const EmmentalDefinition* definition, std::uint64_t& key)
+{
+	// The powers stand for the sizes of the stack and the queue
+	key = Mix(definition->GetContentHash(), StackHash);
+	key = Mix(key, StackPower);
+	key = Mix(key, QueueHash * QueueHeadInverse);
+	key = Mix(key, QueueTailPower * QueueHeadInverse);
+	key = Mix(key, DefinitionsHash);
+	key = Mix(key, EventCount);
+
+	return Executing.insert(key).second;
+}
+
+void CycleDetector::Leave(std::uint64_t key) { Executing.erase(key); }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <unordered_set>
+#include "Config.h"
+
+// Detects recursion that can never end: an interpreted definition executed again, nested in its own execution, with the same stack,
+// queue and contents of the current definitions, and without reading input in between. Execution from that state is deterministic,
+// so it reaches the same call again and again, and would only stop at the recursion limit. That only holds in strict mode: in lenient mode,
+// the recursion limit skips the deepest call and the program goes on, so a detected recursion may still end, and is only reported.
+// States are compared by hashes that are updated along with the stack, queue and definitions, so a check costs a hash table lookup.
+// Equal hashes are taken as equal states, a false detection would take a 64-bit hash collision.
+class CycleDetector
+{
+public:
+	CycleDetector();
+
+	// Mixes a value into a hash. Also used by definitions to hash their contents.
+	static std::uint64_t Mix(std::uint64_t hash, std::uint64_t value)
+	{
+		hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+		hash ^= hash >> 31;
+		hash *= 0xBF58476D1CE4E5B9ULL;
+		return hash ^ (hash >> 29);
+	}
+
+	// The stack and the queue are hashed as polynomials of their symbols, so a symbol can be added or removed at either end in constant time
+	void Pushed(SymbolT item)
+	{
+		StackHash += Mix(0, item) * StackPower;
+		StackPower *= Base;
+	}
+
+	void Popped(SymbolT item)
+	{
+		StackPower *= InverseBase;
+		StackHash -= Mix(0, item) * StackPower;
+	}
+
+	void Enqueued(SymbolT item)
+	{
+		QueueHash += Mix(0, item) * QueueTailPower;
+		QueueTailPower *= Base;
+	}
+
+	void Dequeued(SymbolT item)
+	{
+		QueueHash -= Mix(0, item) * QueueHeadPower;
+		QueueHeadPower *= Base;
+		QueueHeadInverse *= InverseBase;
+	}
+
+	void StackCleared();
+	void QueueCleared();
+	// A symbol's definition changed, either may be nullptr if undefined
+	void Redefined(SymbolT symbol, const class EmmentalDefinition* previous, const class EmmentalDefinition* current);
+	// All definitions were replaced
+	void DefinitionsReplaced(const SymbolMapT& definitions);
+	// Reading input, or skipping a call at the recursion limit, changes how execution continues in ways the state doesn't hash
+	void EventHappened() { EventCount++; }
+
+	// Records that a definition starts executing, and outputs the key to pass to Leave() once it finishes.
+	// Returns false, without recording it, if the definition is already executing with the same state.
+	bool Enter(const class EmmentalDefinition* definition, std::uint64_t& key);
+	void Leave(std::uint64_t key);
+
+private:
+	static const std::uint64_t Base = 0x100000001B3ULL;
+	static const std::uint64_t InverseBase;
+
+	std::uint64_t StackHash = 0;
+	std::uint64_t StackPower = 1;
+	// Symbols are hashed at their position since the queue was cleared, and the hash is shifted back by the position of the front
+	std::uint64_t QueueHash = 0;
+	std::uint64_t QueueHeadPower = 1;
+	std::uint64_t QueueHeadInverse = 1;
+	std::uint64_t QueueTailPower = 1;
+	std::uint64_t DefinitionsHash = 0;
+	std::uint64_t EventCount = 0;
+
+	std::unordered_set<std::uint64_t> Executing;
+};
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "Debugger.h"
+#include <limits>
+
+// Continue() runs until the program finishes or pauses, whatever number of steps that takes
+static const std::uint64_t UnlimitedSteps = std::numeric_limits<std::uint64_t>::max();
+
+Debugger::Debugger(Emmental& interpreter) : Interpreter(interpreter)
+{
+}
+
+Debugger::~Debugger()
+{
+	if (HoldingDefinitions)
+		Interpreter.ReleaseDefinitions();
+}
+
+unsigned int Debugger::AddBreakpoint(BreakpointKind kind, SymbolT value)
+{
+	std::shared_ptr<EmmentalDefinition> definition;
+
+	if (kind == BreakpointKind::Definition || kind == BreakpointKind::Redefinition)
+	{
+		definition = Interpreter.GetDefinition(value);
+		if (!definition && kind == BreakpointKind::Definition)
+			return 0;
+	}
+
+	Breakpoints.push_back({ NextId, kind, value, std::move(definition) });
+	UpdateHold();
+	return NextId++;
+}
+
+bool Debugger::RemoveBreakpoint(unsigned int id)
+{
+	for (auto i = Breakpoints.begin(); i != Breakpoints.end(); ++i)
+	{
+		if (i->Id == id)
+		{
+			if (HitId == id)
+				HitId = 0;
+
+			Breakpoints.erase(i);
+			UpdateHold();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Debugger::ClearBreakpoints()
+{
+	Breakpoints.clear();
+	HitId = 0;
+	UpdateHold();
+}
+
+const std::vector<Debugger::Breakpoint>& Debugger::GetBreakpoints() const { return Breakpoints; }
+
+void Debugger::RequestPause() { PauseRequested = true; }
+
+bool Debugger::IsActive() const { return PauseRequested || !Breakpoints.empty(); }
+
+bool Debugger::IsPaused() const { return Task != nullptr; }
+
+Debugger::Status Debugger::Start(const char* program, std::size_t size)
+{
+	Task.reset(new ExecutionTask(Interpreter, program, size));
+	NextStepChecked = false;
+
+	bool pause = PauseRequested;
+	PauseRequested = false;
+	return Run(pause ? 0 : UnlimitedSteps);
+}
+
+Debugger::Status Debugger::Continue() { return Run(UnlimitedSteps); }
+
+Debugger::Status Debugger::Step(std::uint64_t count) { return Run(count); }
+
+void Debugger::Abandon()
+{
+	Task.reset();
+	HitId = 0;
+}
+
+const Debugger::Breakpoint* Debugger::GetHit() const
+{
+	for (const Breakpoint& breakpoint : Breakpoints)
+	{
+		if (breakpoint.Id == HitId)
+			return &breakpoint;
+	}
+
+	return nullptr;
+}
+
+bool Debugger::GetNextStep(ExecutionTask::NextStep& next) const { return Task->PeekStep(next); }
+
+std::uint64_t Debugger::GetStepCount() const { return Task->GetStepCount(); }
+
+Debugger::Status Debugger::Run(std::uint64_t steps)
+{
+	HitId = 0;
+	bool check = !NextStepChecked;
+	Rewatch();
+
+	try
+	{
+		while (true)
+		{
+			ExecutionTask::NextStep next;
+			if (!Task->PeekStep(next))
+				return Finish();
+
+			if (check)
+			{
+				const Breakpoint* hit = FindBreakpoint(next);
+				if (hit)
+				{
+					HitId = hit->Id;
+					NextStepChecked = true;
+					return Status::Paused;
+				}
+			}
+
+			if (steps == 0)
+			{
+				NextStepChecked = true;
+				return Status::Paused;
+			}
+
+			check = true;
+
+			if (Breakpoints.empty())
+			{
+				// Nothing can pause the program before the steps run out, so they're all executed in one go,
+				// and definitions with a static effect are executed without frames
+				std::uint64_t stepCount = Task->GetStepCount();
+				if (Task->Run(steps) == ExecutionTask::Status::Finished)
+					return Finish();
+
+				steps -= Task->GetStepCount() - stepCount;
+				continue;
+			}
+
+			std::size_t stackSize = Interpreter.GetStackSize();
+			std::size_t queueSize = Interpreter.GetQueueSize();
+			Task->Run(1);
+			steps--;
+
+			const Breakpoint* hit = FindWatchpoint(stackSize, queueSize);
+			if (hit)
+			{
+				HitId = hit->Id;
+				NextStepChecked = false;
+				return Status::Paused;
+			}
+		}
+	}
+	catch (...)
+	{
+		Abandon();
+		throw;
+	}
+}
+
+void Debugger::UpdateHold()
+{
+	bool hold = false;
+	for (const Breakpoint& breakpoint : Breakpoints)
+	{
+		if (breakpoint.Kind == BreakpointKind::Definition || breakpoint.Kind == BreakpointKind::Redefinition)
+			hold = true;
+	}
+
+	if (hold && !HoldingDefinitions)
+		Interpreter.HoldDefinitions();
+	else if (!hold && HoldingDefinitions)
+		Interpreter.ReleaseDefinitions();
+
+	HoldingDefinitions = hold;
+}
+
+void Debugger::Rewatch()
+{
+	WatchedVersion = Interpreter.GetDefinitionsVersion();
+
+	for (Breakpoint& breakpoint : Breakpoints)
+	{
+		if (breakpoint.Kind == BreakpointKind::Redefinition)
+			breakpoint.Definition = Interpreter.GetDefinition(breakpoint.Value);
+	}
+}
+
+const Debugger::Breakpoint* Debugger::FindBreakpoint(const ExecutionTask::NextStep& next) const
+{
+	for (const Breakpoint& breakpoint : Breakpoints)
+	{
+		switch (breakpoint.Kind)
+		{
+		case BreakpointKind::Symbol:
+			if (next.Symbol == breakpoint.Value)
+				return &breakpoint;
+			break;
+
+		case BreakpointKind::Definition:
+			if (next.Definition == breakpoint.Definition.get())
+				return &breakpoint;
+			break;
+
+		case BreakpointKind::Position:
+			if (next.Position == breakpoint.Value && next.RecursionLevel == 0)
+				return &breakpoint;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return nullptr;
+}
+
+const Debugger::Breakpoint* Debugger::FindWatchpoint(std::size_t previousStackSize, std::size_t previousQueueSize)
+{
+	const Breakpoint* hit = nullptr;
+
+	// Most steps don't change any definition, which the version tells without looking up the watched symbols
+	bool redefined = Interpreter.GetDefinitionsVersion() != WatchedVersion;
+	WatchedVersion = Interpreter.GetDefinitionsVersion();
+
+	for (Breakpoint& breakpoint : Breakpoints)
+	{
+		bool triggered = false;
+
+		switch (breakpoint.Kind)
+		{
+		case BreakpointKind::StackSize:
+			triggered = previousStackSize < breakpoint.Value && Interpreter.GetStackSize() >= breakpoint.Value;
+			break;
+
+		case BreakpointKind::QueueSize:
+			triggered = previousQueueSize < breakpoint.Value && Interpreter.GetQueueSize() >= breakpoint.Value;
+			break;
+
+		case BreakpointKind::Redefinition:
+			// Every watched symbol takes its new definition as seen, even if another watchpoint is reported
+			if (redefined && Interpreter.BorrowDefinition(breakpoint.Value) != breakpoint.Definition.get())
+			{
+				breakpoint.Definition = Interpreter.GetDefinition(breakpoint.Value);
+				triggered = true;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		if (triggered && !hit)
+			hit = &breakpoint;
+	}
+
+	return hit;
+}
+
+Debugger::Status Debugger::Finish()
+{
+	Abandon();
+	return Status::Finished;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Config.h"
+#include "Emmental.h"
+#include "ExecutionTask.h"
+
+// Runs programs as an ExecutionTask that can be paused at breakpoints, before a step, and at watchpoints, after a step changed something.
+// Definitions are shared and never change once created, so breakpoints aren't patched into them: while any breakpoint or watchpoint is
+// set, the task is run one step at a time and they're checked between steps. Without any, programs run in one go at full speed.
+class Debugger
+{
+public:
+	enum class BreakpointKind
+	{
+		// Before executing a symbol, anywhere
+		Symbol,
+		// Before calling a definition, through any symbol it's captured or defined as
+		Definition,
+		// Before executing the symbol at a position of the program, but not the symbols of the calls it makes
+		Position,
+		// After the stack or queue grows to hold at least a number of symbols
+		StackSize,
+		QueueSize,
+		// After a symbol is redefined or undefined
+		Redefinition
+	};
+
+	struct Breakpoint
+	{
+		unsigned int Id;
+		BreakpointKind Kind;
+		// Symbol, position or size, depending on the kind
+		SymbolT Value;
+		// Definition a Definition breakpoint stops at, or the last definition seen of a watched symbol
+		std::shared_ptr<EmmentalDefinition> Definition;
+	};
+
+	enum class Status
+	{
+		Finished,
+		Paused
+	};
+
+	// Creates a debugger for an interpreter, which must outlive it
+	explicit Debugger(Emmental& interpreter);
+	~Debugger();
+	Debugger(const Debugger&) = delete;
+	Debugger& operator=(const Debugger&) = delete;
+
+	// Adds a breakpoint or watchpoint and returns its id. A Definition breakpoint stops at the current definition of the symbol Value,
+	// and fails with 0 if it's undefined.
+	unsigned int AddBreakpoint(BreakpointKind kind, SymbolT value);
+	// Returns false if there's no breakpoint with the id
+	bool RemoveBreakpoint(unsigned int id);
+	void ClearBreakpoints();
+	const std::vector<Breakpoint>& GetBreakpoints() const;
+
+	// Makes the next program started pause before its first step
+	void RequestPause();
+	// Checks if a program should be started by the debugger instead of interpreted directly, as it could pause
+	bool IsActive() const;
+	bool IsPaused() const;
+
+	// Starts the program text in [program, program + size), abandoning a paused one, and runs it until it finishes or pauses.
+	// Errors are thrown as in Emmental::Interpret(), and finish the program.
+	Status Start(const char* program, std::size_t size);
+	// Runs the paused program until it finishes or pauses again
+	Status Continue();
+	// Executes at most count steps of the paused program, and pauses after them unless it finishes or pauses earlier
+	Status Step(std::uint64_t count);
+	// Stops the paused program without finishing it
+	void Abandon();
+
+	// Gets the breakpoint the program paused at, or nullptr if it paused after stepping or at a requested pause
+	const Breakpoint* GetHit() const;
+	// Gets the step the paused program executes next. Returns false if it paused at a watchpoint after its last step.
+	bool GetNextStep(ExecutionTask::NextStep& next) const;
+	// Gets the number of steps the paused program executed
+	std::uint64_t GetStepCount() const;
+
+private:
+	Emmental& Interpreter;
+	std::unique_ptr<ExecutionTask> Task;
+	std::vector<Breakpoint> Breakpoints;
+	unsigned int NextId = 1;
+	bool PauseRequested = false;
+	// Id of the breakpoint paused at, 0 if none
+	unsigned int HitId = 0;
+	// Set if the program paused after checking its next step for breakpoints, so resuming executes that step without checking it again
+	bool NextStepChecked = false;
+	// Definitions version the Redefinition watchpoints were last checked at
+	std::uint64_t WatchedVersion = 0;
+	// Set while the interpreter's definitions are held, so compaction doesn't move the definitions breakpoints compare by address
+	bool HoldingDefinitions = false;
+
+	// Holds the interpreter's definitions while any Definition breakpoint or Redefinition watchpoint is set
+	void UpdateHold();
+	// Runs the program for at most steps steps, checking breakpoints before every step but the first one if it was already checked
+	Status Run(std::uint64_t steps);
+	// Takes the current definitions of watched symbols as seen, so changes made while paused aren't reported
+	void Rewatch();
+	// Finds the breakpoint that stops a step, or the watchpoint triggered by the last step given the sizes before it
+	const Breakpoint* FindBreakpoint(const ExecutionTask::NextStep& next) const;
+	const Breakpoint* FindWatchpoint(std::size_t previousStackSize, std::size_t previousQueueSize);
+	Status Finish();
+};
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "DefinitionGraph.h"
+#include <unordered_set>
+#include "InterpretedDefinition.h"
+
+std::vector<std::shared_ptr<EmmentalDefinition>> DefinitionGraph::Collect(const SymbolMapT& roots)
+{
+	struct Frame
+	{
+		std::shared_ptr<EmmentalDefinition> Definition;
+		std::vector<std::shared_ptr<EmmentalDefinition>> Captures;
+		std::size_t Next;
+	};
+
+	std::vector<std::shared_ptr<EmmentalDefinition>> result;
+	std::unordered_set<const EmmentalDefinition*> visited;
+	// Capture chains grow with every redefinition that refers to the previous definition, so they are walked without recursion
+	std::vector<Frame> frames;
+
+	auto visit = [&](const std::shared_ptr<EmmentalDefinition>& definition)
+	{
+		if (!visited.insert(definition.get()).second)
+			return;
+
+		Frame frame = { definition, {}, 0 };
+		const InterpretedDefinition* interpreted = dynamic_cast<const InterpretedDefinition*>(definition.get());
+
+		if (interpreted)
+		{
+			for (auto& pair : interpreted->GetDefinitions())
+				frame.Captures.push_back(pair.second);
+		}
+
+		frames.push_back(std::move(frame));
+	};
+
+	for (auto& pair : roots)
+	{
+		visit(pair.second);
+
+		while (!frames.empty())
+		{
+			Frame& top = frames.back();
+
+			if (top.Next < top.Captures.size())
+			{
+				// Copied, as visiting may reallocate the frames
+				std::shared_ptr<EmmentalDefinition> capture = top.Captures[top.Next++];
+				visit(capture);
+			}
+			else
+			{
+				result.push_back(std::move(top.Definition));
+				frames.pop_back();
+			}
+		}
+	}
+
+	return result;
+}
\ No newline at end of file
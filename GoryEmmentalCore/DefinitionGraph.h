@@ -0,0 +1,12 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include "Config.h"
+
+// Analysis of the graph formed by definitions and the definitions they capture
+namespace DefinitionGraph
+{
+	// Gets the transitive closure of definitions reachable from roots through captures.
+	// Each definition appears once, after all of its captures.
+	std::vector<std::shared_ptr<EmmentalDefinition>> Collect(const SymbolMapT& roots);
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "DefinitionTable.h"
+#include "EmmentalDefinition.h"
+
+DefinitionTable::DefinitionTable(const SymbolMapT& map)
+{
+	for (auto& pair : map)
+		Set(pair.first, pair.second);
+}
+
+std::shared_ptr<EmmentalDefinition> DefinitionTable::GetShared(SymbolT symbol) const
+{
+	if (symbol < ByteCount)
+		return Bytes[symbol];
+
+	auto result = Wide.find(symbol);
+
+	if (result == Wide.end())
+		return nullptr;
+
+	return result->second;
+}
+
+void DefinitionTable::Set(SymbolT symbol, std::shared_ptr<EmmentalDefinition> definition)
+{
+	Exchange(symbol, std::move(definition));
+}
+
+std::shared_ptr<EmmentalDefinition> DefinitionTable::Exchange(SymbolT symbol, std::shared_ptr<EmmentalDefinition> definition)
+{
+	if (symbol < ByteCount)
+	{
+		Bytes[symbol].swap(definition);
+		return definition;
+	}
+
+	auto entry = Wide.find(symbol);
+	std::shared_ptr<EmmentalDefinition> previous;
+
+	if (entry != Wide.end())
+	{
+		previous = std::move(entry->second);
+
+		if (definition)
+			entry->second = std::move(definition);
+		else
+			Wide.erase(entry);
+	}
+	else if (definition)
+	{
+		Wide[symbol] = std::move(definition);
+	}
+
+	return previous;
+}
+
+SymbolMapT DefinitionTable::Clear()
+{
+	SymbolMapT previous;
+	previous.swap(Wide);
+
+	for (std::size_t i = 0; i < ByteCount; i++)
+	{
+		if (Bytes[i])
+			previous[i] = std::move(Bytes[i]);
+	}
+
+	return previous;
+}
+
+SymbolMapT DefinitionTable::ToMap() const
+{
+	SymbolMapT result(Wide);
+
+	for (std::size_t i = 0; i < ByteCount; i++)
+	{
+		if (Bytes[i])
+			result[i] = Bytes[i];
+	}
+
+	return result;
+}
+
+EmmentalDefinition* DefinitionTable::GetWide(SymbolT symbol) const
+{
+	auto result = Wide.find(symbol);
+
+	if (result == Wide.end())
+		return nullptr;
+
+	return result->second.get();
+}
\ No newline at end of file
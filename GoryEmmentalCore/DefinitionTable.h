@@ -0,0 +1,42 @@
+#pragma once
+#include <map>
+#include <memory>
+#include "Config.h"
+
+class EmmentalDefinition;
+
+// Maps symbols to definitions. Byte symbols are stored in a flat array so lookups and copies are cheap, wider symbols in a map.
+class DefinitionTable
+{
+public:
+	DefinitionTable() = default;
+	explicit DefinitionTable(const SymbolMapT& map);
+
+	// Gets the definition of a symbol without sharing its ownership. Returns nullptr if not defined.
+	EmmentalDefinition* Get(SymbolT symbol) const
+	{
+		if (symbol < ByteCount)
+			return Bytes[symbol].get();
+
+		return GetWide(symbol);
+	}
+
+	// Gets the definition of a symbol. Returns nullptr if not defined.
+	std::shared_ptr<EmmentalDefinition> GetShared(SymbolT symbol) const;
+	// Sets the definition of a symbol, or undefines it if definition is nullptr.
+	void Set(SymbolT symbol, std::shared_ptr<EmmentalDefinition> definition);
+	// Same as Set(), returning the previous definition of the symbol.
+	std::shared_ptr<EmmentalDefinition> Exchange(SymbolT symbol, std::shared_ptr<EmmentalDefinition> definition);
+	// Undefines all symbols, returning the previous definitions.
+	SymbolMapT Clear();
+	// Copies all definitions to a map
+	SymbolMapT ToMap() const;
+
+private:
+	static const std::size_t ByteCount = 256;
+
+	std::shared_ptr<EmmentalDefinition> Bytes[ByteCount];
+	SymbolMapT Wide;
+
+	EmmentalDefinition* GetWide(SymbolT symbol) const;
+};
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "DiagnosticLimiter.h"
+#include "CycleDetector.h"
+#include "Util.h"
+
+DiagnosticLimiter::DiagnosticLimiter(std::uint64_t limit) : Limit(limit)
+{
+}
+
+bool DiagnosticLimiter::Count(Kind kind, SymbolT symbol)
+{
+	if (Limit == 0)
+		return true;
+
+	if (LastIndex >= Entries.size() || Entries[LastIndex].DiagnosticKind != kind || Entries[LastIndex].Symbol != symbol)
+	{
+		auto found = Indices.find(std::make_pair(kind, symbol));
+
+		if (found == Indices.end())
+		{
+			found = Indices.emplace(std::make_pair(kind, symbol), Entries.size()).first;
+			Entries.push_back({ kind, symbol, 0 });
+		}
+
+		LastIndex = found->second;
+	}
+
+	return ++Entries[LastIndex].Count <= Limit;
+}
+
+static void DescribeKind(DiagnosticLimiter::Kind kind, SymbolT symbol, std::ostream& output)
+{
+	switch (kind)
+	{
+	case DiagnosticLimiter::Kind::PopEmptyStack: output << "Popping a symbol from the empty stack"; break;
+	case DiagnosticLimiter::Kind::PopEmptyProgram: output << "Popping a program from the empty stack"; break;
+	case DiagnosticLimiter::Kind::UnterminatedProgram: output << "Running out of stack before the end of a program"; break;
+	case DiagnosticLimiter::Kind::DequeueEmptyQueue: output << "Dequeuing a symbol from the empty queue"; break;
+	case DiagnosticLimiter::Kind::InfiniteRecursion: output << "Detecting infinite recursion"; break;
+
+	case DiagnosticLimiter::Kind::PushFullStack:
+		output << "Pushing symbol ";
+		Util::DescribeSymbol(symbol, output);
+		output << " to the full stack";
+		break;
+
+	case DiagnosticLimiter::Kind::EnqueueFullQueue:
+		output << "Enqueuing symbol ";
+		Util::DescribeSymbol(symbol, output);
+		output << " to the full queue";
+		break;
+
+	case DiagnosticLimiter::Kind::RecursionTooHigh:
+		output << "Exceeding the recursion level at symbol ";
+		Util::DescribeSymbol(symbol, output);
+		break;
+
+	case DiagnosticLimiter::Kind::UndefinedSymbol:
+		output << "Interpreting undefined symbol ";
+		Util::DescribeSymbol(symbol, output);
+		break;
+	}
+}
+
+void DiagnosticLimiter::Summarize(std::ostream& output)
+{
+	for (const Entry& entry : Entries)
+	{
+		if (entry.Count <= Limit)
+			continue;
+
+		Util::Colorize(Util::ConsoleColor::BrightYellow, output);
+		output << "Warning: ";
+		Util::Colorize(Util::ConsoleColor::Default, output);
+		DescribeKind(entry.DiagnosticKind, entry.Symbol, output);
+		std::uint64_t repeats = entry.Count - Limit;
+		output << " was repeated " << repeats << (repeats == 1 ? " more time" : " more times") << " without being printed." << std::endl;
+	}
+
+	Entries.clear();
+	Indices.clear();
+	LastIndex = 0;
+}
+
+std::size_t DiagnosticLimiter::KeyHash::operator()(const std::pair<Kind, SymbolT>& key) const
+{
+	return (std::size_t)CycleDetector::Mix((std::uint64_t)key.first, key.second);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include <unordered_map>
+#include "Config.h"
+
+// Limits how often an interpreter prints the same warning or error. Diagnostics are told apart by their kind and the symbol they're about.
+// Each is printed up to a limit, and its further repeats are only counted and summarized later, so a program that repeats one in a loop
+// doesn't flood the error stream, and runs nearly as fast as it would without printing it.
+class DiagnosticLimiter
+{
+public:
+	enum class Kind
+	{
+		PopEmptyStack,
+		PopEmptyProgram,
+		UnterminatedProgram,
+		PushFullStack,
+		DequeueEmptyQueue,
+		EnqueueFullQueue,
+		RecursionTooHigh,
+		UndefinedSymbol,
+		InfiniteRecursion
+	};
+
+	// Creates a limiter that prints each diagnostic up to limit times, 0 for no limit
+	explicit DiagnosticLimiter(std::uint64_t limit);
+
+	// Counts an occurrence of a diagnostic, and returns true if it should be printed
+	bool Count(Kind kind, SymbolT symbol);
+	// Prints how many repeats of each diagnostic weren't printed, and forgets every diagnostic, so they're printed again afterwards
+	void Summarize(std::ostream& output);
+
+private:
+	struct Entry
+	{
+		Kind DiagnosticKind;
+		SymbolT Symbol;
+		std::uint64_t Count;
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const std::pair<Kind, SymbolT>& key) const;
+	};
+
+	std::uint64_t Limit;
+	// In order of their first occurrence, so the summary follows the printed diagnostics
+	std::vector<Entry> Entries;
+	std::unordered_map<std::pair<Kind, SymbolT>, std::size_t, KeyHash> Indices;
+	// Diagnostics repeated in a loop usually come one after another, so the last one is checked before the table
+	std::size_t LastIndex = 0;
+};
\ No newline at end of file
@@ -0,0 +1,830 @@
+#include "Emmental.h"
+#include "NativeDefinition.h"
+#include "InterpretedDefinition.h"
+#include "Util.h"
+#include "Globals.h"
+#include "EmmentalException.h"
+#include "SymbolSet.h"
+#include "DefinitionGraph.h"
+#include <atomic>
+#include <cctype>
+#include <unordered_map>
+
+static const Util::ConsoleColor ErrorColor = Util::ConsoleColor::BrightRed;
+static const Util::ConsoleColor WarningColor = Util::ConsoleColor::BrightYellow;
+
+// The arena is compacted once it holds at least this many bytes, and less than a quarter of them are live
+static const std::size_t CompactionThreshold = 1024 * 1024;
+
+static const DefinitionTable& GetDefaultDefinitions();
+
+EmmentalOptions::EmmentalOptions()
+	: LenientMode(Globals::LenientMode), QuietMode(Globals::QuietMode), OptimizeProgram(Globals::OptimizeProgram), IgnoreWhitespace(Globals::IgnoreWhitespace),
+	CellWidth(Globals::CellWidth), MaxStackSize(Globals::MaxStackSize), MaxQueueSize(Globals::MaxQueueSize), DetectCycles(Globals::DetectCycles)
+{
+}
+
+Emmental::Emmental(std::istream& inputStream, std::ostream& outputStream, std::ostream& errorStream)
+	: Emmental(inputStream, outputStream, errorStream, EmmentalOptions())
+{
+}
+
+Emmental::Emmental(std::istream& inputStream, std::ostream& outputStream, std::ostream& errorStream, const EmmentalOptions& options)
+	: InputStream(inputStream), OutputStream(outputStream), ErrorStream(errorStream), Options(options),
+	CellWidth(options.CellWidth), CellMask(options.CellWidth >= 64 ? ~SymbolT() : (SymbolT(1) << options.CellWidth) - 1),
+	MaxStackSize(options.MaxStackSize), MaxQueueSize(options.MaxQueueSize),
+	ProgramStack(Globals::SpillDirectory, CellWidth), ProgramQueue(Globals::SpillDirectory, CellWidth),
+	SymbolMap(GetDefaultDefinitions()), DefinitionBytes(std::make_shared<std::size_t>(0)), Arena(std::make_shared<ArenaGeneration>(DefinitionBytes)), Diagnostics(Globals::DiagnosticLimit)
+{
+	if (options.DetectCycles)
+	{
+		Cycles.reset(new CycleDetector());
+		Cycles->DefinitionsReplaced(SymbolMap.ToMap());
+	}
+
+	if (Globals::CollectStats)
+		Stats.reset(new ExecutionStats(MaxStackSize, MaxQueueSize));
+
+	DefinitionsChanged();
+}
+
+unsigned int Emmental::GetCellWidth() const { return CellWidth; }
+std::size_t Emmental::GetMaxStackSize() const { return MaxStackSize; }
+std::size_t Emmental::GetMaxQueueSize() const { return MaxQueueSize; }
+
+std::stack<SymbolT> Emmental::GetStack() const
+{
+	std::stack<SymbolT> result;
+	for (std::size_t i = 0; i < ProgramStack.Size(); i++)
+		result.push(ProgramStack.At(i));
+
+	return result;
+}
+
+SymbolT Emmental::PopSymbol()
+{
+	if (ProgramStack.Empty())
+	{
+		if (BeginDiagnostic(DiagnosticLimiter::Kind::PopEmptyStack, 0))
+		{
+			Util::Colorize(ErrorColor, ErrorStream);
+			ErrorStream << "Error: ";
+			Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+
+			ErrorStream << "Tried popping symbol from empty stack.";
+
+			if (Options.LenientMode)
+				ErrorStream << " Returning default value.";
+
+			ErrorStream << std::endl;
+		}
+
+		if (!Options.LenientMode)
+			throw EmmentalException("Tried popping symbol from empty stack.");
+
+		return SymbolT();
+	}
+
+	SymbolT result = ProgramStack.Back();
+	ProgramStack.PopBack();
+
+	if (Cycles)
+		Cycles->Popped(result);
+
+	return result;
+}
+
+ProgramT Emmental::PopProgram()
+{
+	ProgramT result;
+	PopProgram(result);
+	return result;
+}
+
+void Emmental::PopProgram(ProgramT& result)
+{
+	result.clear();
+
+	if (ProgramStack.Empty())
+	{
+		if (BeginDiagnostic(DiagnosticLimiter::Kind::PopEmptyProgram, 0))
+		{
+			Util::Colorize(ErrorColor, ErrorStream);
+			ErrorStream << "Error: ";
+			Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+			ErrorStream << "Tried popping program from empty stack.";
+
+				if (Options.LenientMode)
+					ErrorStream << " Returning default program.";
+
+			ErrorStream << std::endl;
+		}
+
+		if (!Options.LenientMode)
+			throw EmmentalException("Tried popping program from empty stack.");
+
+		return;
+	}
+
+	SymbolT symbol = PopSymbol();
+	
+	while (symbol != ';')
+	{
+		result.push_back(symbol);
+
+		if (ProgramStack.Empty())
+		{
+			if (BeginDiagnostic(DiagnosticLimiter::Kind::UnterminatedProgram, 0))
+			{
+				Util::Colorize(ErrorColor, ErrorStream);
+				ErrorStream << "Error: ";
+				Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+				ErrorStream << "Stack ran out before ";
+				Util::DescribeSymbol(';', ErrorStream);
+				ErrorStream << " was found to terminate a program.";
+
+				if (Options.LenientMode)
+					ErrorStream << " Returning incomplete program.";
+
+				ErrorStream << std::endl;
+			}
+
+			if (!Options.LenientMode)
+				throw EmmentalException("Stack ran out before ';' was found to terminate a program.");
+
+			break;
+		}
+		else
+		{
+			symbol = PopSymbol();
+		}
+	}
+
+	std::reverse(result.begin(), result.end());
+}
+
+void Emmental::Push(SymbolT item)
+{
+	if (ProgramStack.Size() >= MaxStackSize)
+	{
+		if (BeginDiagnostic(DiagnosticLimiter::Kind::PushFullStack, item))
+		{
+			Util::Colorize(ErrorColor, ErrorStream);
+			ErrorStream << "Error: ";
+			Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+			ErrorStream << "Tried to push symbol ";
+			Util::DescribeSymbol(item, ErrorStream);
+			ErrorStream << " to full stack.";
+
+			if (Options.LenientMode)
+				ErrorStream << " Ignoring.";
+
+			ErrorStream << std::endl;
+		}
+
+		if (!Options.LenientMode)
+			throw EmmentalException("Stack full.");
+
+		return;
+	}
+
+	ProgramStack.PushBack(item & CellMask);
+
+	if (Cycles)
+		Cycles->Pushed(item & CellMask);
+}
+
+SymbolT Emmental::PopSymbolUnchecked()
+{
+	SymbolT result = ProgramStack.Back();
+	ProgramStack.PopBack();
+
+	return result;
+}
+
+void Emmental::PushUnchecked(SymbolT item)
+{
+	ProgramStack.PushBack(item & CellMask);
+}
+
+bool Emmental::CanExecuteUnchecked(const StackEffect& effect) const
+{
+	// Unchecked operations don't keep the cycle detector's hashes up to date, and aren't counted in the statistics
+	if (Cycles || Stats)
+		return false;
+
+	std::ptrdiff_t stackSize = (std::ptrdiff_t)ProgramStack.Size();
+	std::ptrdiff_t queueSize = (std::ptrdiff_t)ProgramQueue.Size();
+
+	return stackSize >= effect.StackRequired && stackSize + effect.StackGrowth <= (std::ptrdiff_t)MaxStackSize
+		&& queueSize >= effect.QueueRequired && queueSize + effect.QueueGrowth <= (std::ptrdiff_t)MaxQueueSize;
+}
+
+void Emmental::ClearStack()
+{
+	ProgramStack.Clear();
+
+	if (Cycles)
+		Cycles->StackCleared();
+}
+
+std::queue<SymbolT> Emmental::GetQueue() const
+{
+	std::queue<SymbolT> result;
+	for (std::size_t i = 0; i < ProgramQueue.Size(); i++)
+		result.push(ProgramQueue.At(i));
+
+	return result;
+}
+
+SymbolT Emmental::Dequeue()
+{
+	if (ProgramQueue.Empty())
+	{
+		if (BeginDiagnostic(DiagnosticLimiter::Kind::DequeueEmptyQueue, 0))
+		{
+			Util::Colorize(ErrorColor, ErrorStream);
+			ErrorStream << "Error: ";
+			Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+
+			ErrorStream << "Tried dequeuing symbol from empty queue.";
+
+			if (Options.LenientMode)
+				ErrorStream << " Returning default value.";
+
+			ErrorStream << std::endl;
+		}
+
+		if (!Options.LenientMode)
+			throw EmmentalException("Tried dequeuing symbol from empty queue.");
+
+		return SymbolT();
+	}
+
+	SymbolT result = ProgramQueue.Front();
+	ProgramQueue.PopFront();
+
+	if (Cycles)
+		Cycles->Dequeued(result);
+
+	return result;
+}
+
+void Emmental::Enqueue(SymbolT item)
+{
+	if (ProgramQueue.Size() >= MaxQueueSize)
+	{
+		if (BeginDiagnostic(DiagnosticLimiter::Kind::EnqueueFullQueue, item))
+		{
+			Util::Colorize(ErrorColor, ErrorStream);
+			ErrorStream << "Error: ";
+			Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+			ErrorStream << "Tried to enqueue symbol ";
+			Util::DescribeSymbol(item, ErrorStream);
+			ErrorStream << " to full queue.";
+
+			if (Options.LenientMode)
+				ErrorStream << " Ignoring.";
+
+			ErrorStream << std::endl;
+		}
+
+		if (!Options.LenientMode)
+			throw EmmentalException("Queue full.");
+
+		return;
+	}
+
+	ProgramQueue.PushBack(item);
+
+	if (Cycles)
+		Cycles->Enqueued(item);
+}
+
+SymbolT Emmental::DequeueUnchecked()
+{
+	SymbolT result = ProgramQueue.Front();
+	ProgramQueue.PopFront();
+
+	return result;
+}
+
+void Emmental::EnqueueUnchecked(SymbolT item)
+{
+	ProgramQueue.PushBack(item);
+}
+
+void Emmental::ClearQueue()
+{
+	ProgramQueue.Clear();
+
+	if (Cycles)
+		Cycles->QueueCleared();
+}
+
+SymbolT Emmental::ReadInput()
+{
+	BeginEffect();
+
+	unsigned char byte;
+	InputStream >> byte;
+
+	if (Cycles)
+		Cycles->EventHappened();
+
+	return byte;
+}
+
+bool Emmental::IsInputAvailable() const
+{
+	std::streambuf* buffer = InputStream.rdbuf();
+
+	// Formatted reads skip whitespace, so buffered whitespace alone doesn't make a symbol available
+	while (buffer->in_avail() > 0)
+	{
+		if (!(InputStream.flags() & std::ios_base::skipws) || !std::isspace(buffer->sgetc()))
+			return true;
+
+		buffer->sbumpc();
+	}
+
+	return false;
+}
+
+void Emmental::WriteOutput(SymbolT symbol)
+{
+	BeginEffect();
+	OutputStream << (unsigned char)symbol;
+}
+
+std::shared_ptr<EmmentalDefinition> Emmental::GetDefinition(SymbolT symbol) const { return SymbolMap.GetShared(symbol); }
+
+EmmentalDefinition* Emmental::BorrowDefinition(SymbolT symbol) const { return SymbolMap.Get(symbol); }
+
+SymbolMapT Emmental::CopyDefinitions() const { return SymbolMap.ToMap(); }
+
+SymbolMapT Emmental::CopyDefinitions(const ProgramT& program) const
+{
+	SymbolMapT result;
+	SymbolSet copied;
+
+	for (SymbolT symbol : program)
+	{
+		if (!copied.Insert(symbol))
+			continue;
+
+		std::shared_ptr<EmmentalDefinition> definition = SymbolMap.GetShared(symbol);
+
+		if (definition)
+			result[symbol] = std::move(definition);
+	}
+
+	return result;
+}
+
+void Emmental::ResetDefinitions()
+{
+	RetireAll();
+	NewArenaGeneration();
+	SymbolMap = GetDefaultDefinitions();
+	DefinitionsChanged();
+
+	if (Cycles)
+		Cycles->DefinitionsReplaced(SymbolMap.ToMap());
+}
+
+std::shared_ptr<EmmentalDefinition> Emmental::CreateDefinition(const ProgramT& program, const SymbolMapT& state)
+{
+	return CreateDefinition(program, DefinitionTable(state));
+}
+
+std::shared_ptr<EmmentalDefinition> Emmental::CreateDefinition(const ProgramT& program, const DefinitionTable& state)
+{
+	ArenaAllocator<InterpretedDefinition> allocator(Arena);
+
+	if (!Stats)
+		return std::allocate_shared<InterpretedDefinition>(allocator, program, state, allocator);
+
+	std::size_t allocated = Arena->GetAllocatedBytes();
+	std::shared_ptr<EmmentalDefinition> definition = std::allocate_shared<InterpretedDefinition>(allocator, program, state, allocator);
+	Stats->DefinitionBytes += Arena->GetAllocatedBytes() - allocated;
+	return definition;
+}
+
+void Emmental::Supplant()
+{
+	SymbolT symbol = PopSymbol();
+	PopProgram(SupplantBuffer);
+
+	// Redefine() will take care of undefining the symbol if the definition is nullptr
+	Redefine(symbol, CompileDefinition(SupplantBuffer, SymbolMap));
+}
+
+std::shared_ptr<EmmentalDefinition> Emmental::CompileDefinition(const ProgramT& program, const DefinitionTable& state)
+{
+	// Captured definitions are inlined by InterpretedDefinition, without changing recursion levels.
+	// With program optimization, a program that is at most one symbol long is also inlined into the symbol being defined itself, saving a recursion level:
+	// an empty program undefines the symbol (makes it a no-op), and a single-symbol program shares the single symbol's definition.
+	if (Options.OptimizeProgram && program.size() <= 1)
+		return program.empty() ? nullptr : state.GetShared(program[0]);
+
+	return CreateDefinition(program, state);
+}
+
+void Emmental::NewArenaGeneration()
+{
+	// Every definition keeps its generation alive, so if only the interpreter references it nothing allocated from it is alive.
+	// Otherwise, the old generation is released in one step once its last definition dies.
+	if (Arena.use_count() == 1)
+		Arena->Rewind();
+	else
+		Arena = std::make_shared<ArenaGeneration>(DefinitionBytes);
+}
+
+void Emmental::CompactDefinitions()
+{
+	// Rebuild every reachable definition in a new generation. The old generation, with the memory of every obsolete definition, is released with the last old copy.
+	SymbolMapT definitions = CopyDefinitions();
+	std::vector<std::shared_ptr<EmmentalDefinition>> nodes = DefinitionGraph::Collect(definitions);
+	std::unordered_map<const EmmentalDefinition*, std::shared_ptr<EmmentalDefinition>> copies;
+
+	Arena = std::make_shared<ArenaGeneration>(DefinitionBytes);
+
+	for (auto& node : nodes)
+	{
+		const InterpretedDefinition* interpreted = dynamic_cast<const InterpretedDefinition*>(node.get());
+
+		if (!interpreted)
+		{
+			copies[node.get()] = node;
+			continue;
+		}
+
+		DefinitionTable captures;
+		for (auto& pair : interpreted->GetDefinitions())
+			captures.Set(pair.first, copies.at(pair.second.get()));
+
+		copies[node.get()] = CreateDefinition(interpreted->GetProgram(), captures);
+	}
+
+	for (auto& pair : definitions)
+		pair.second = copies.at(pair.second.get());
+
+	SetDefinitions(definitions);
+}
+
+void Emmental::HoldDefinitions() { DefinitionHolds++; }
+
+void Emmental::ReleaseDefinitions() { DefinitionHolds--; }
+
+void Emmental::SetDefinitions(const SymbolMapT& definitions)
+{
+	RetireAll();
+	SymbolMap = DefinitionTable(definitions);
+	DefinitionsChanged();
+
+	if (Cycles)
+		Cycles->DefinitionsReplaced(definitions);
+}
+
+std::size_t Emmental::GetDefinitionBytes() const { return *DefinitionBytes; }
+
+std::uint64_t Emmental::GetDefinitionsVersion() const { return DefinitionsVersion; }
+
+void Emmental::DefinitionsChanged()
+{
+	static std::atomic<std::uint64_t> NextVersion(1);
+	DefinitionsVersion = NextVersion++;
+}
+
+void Emmental::Interpret(SymbolT symbol) { Interpret(symbol, 0); }
+void Emmental::Interpret(SymbolT symbol, std::size_t recursionLevel) { Execute(SymbolMap.Get(symbol), symbol, recursionLevel); }
+void Emmental::Interpret(SymbolT symbol, const SymbolMapT& state) { Interpret(symbol, state, 0); }
+
+void Emmental::Interpret(SymbolT symbol, const SymbolMapT& state, std::size_t recursionLevel)
+{
+	Execute(GetDefinition(symbol, state), symbol, recursionLevel);
+}
+
+void Emmental::Execute(EmmentalDefinition* definition, SymbolT symbol, std::size_t recursionLevel)
+{
+	if (Stats)
+		Stats->Executed(definition, recursionLevel);
+
+	if (recursionLevel >= EMMENTAL_MAX_RECURSION_LEVEL)
+	{
+		if (BeginDiagnostic(DiagnosticLimiter::Kind::RecursionTooHigh, symbol))
+		{
+			Util::Colorize(ErrorColor, ErrorStream);
+			ErrorStream << "Error: ";
+			Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+			ErrorStream << "Recursion level too high.";
+
+			if (Options.LenientMode)
+			{
+				ErrorStream << " Ignoring symbol ";
+				Util::DescribeSymbol(symbol, ErrorStream);
+				ErrorStream << "." << std::endl;
+			}
+
+			ErrorStream << std::endl;
+		}
+
+		if (!Options.LenientMode)
+			throw EmmentalException("Recursion level too high.");
+
+		if (Cycles)
+			Cycles->EventHappened();
+
+		return;
+	}
+
+	if (definition)
+	{
+		ExecutingDefinitions.push_back(definition);
+
+		try
+		{
+			definition->Execute(this, recursionLevel + 1);
+		}
+		catch (...)
+		{
+			FinishExecution();
+			throw;
+		}
+
+		FinishExecution();
+
+		// Natives pop everything before they push, so the peaks are reached after them
+		if (Stats && definition->AsNative())
+			Stats->Resized(ProgramStack.Size(), ProgramQueue.Size());
+
+		// Only between top-level symbols, when no old definition is borrowed anymore, by the execution path nor by the frames of a task
+		if (ExecutingDefinitions.empty() && DefinitionHolds == 0 && Arena->GetReservedBytes() >= CompactionThreshold && Arena->GetAllocatedBytes() < Arena->GetReservedBytes() / 4)
+			CompactDefinitions();
+	}
+	else
+	{
+		if (BeginDiagnostic(DiagnosticLimiter::Kind::UndefinedSymbol, symbol))
+		{
+			Util::Colorize(WarningColor, ErrorStream);
+			ErrorStream << "Warning: ";
+			Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+			ErrorStream << "Tried to interpret undefined symbol ";
+			Util::DescribeSymbol(symbol, ErrorStream);
+			ErrorStream << ". Ignoring symbol." << std::endl;
+		}
+	}
+}
+
+void Emmental::Redefine(SymbolT symbol, std::shared_ptr<EmmentalDefinition> definition)
+{
+	if (definition)
+	{
+		const EmmentalDefinition* current = definition.get();
+		std::shared_ptr<EmmentalDefinition> previous = SymbolMap.Exchange(symbol, std::move(definition));
+
+		if (Cycles)
+			Cycles->Redefined(symbol, previous.get(), current);
+
+		Retire(std::move(previous));
+		DefinitionsChanged();
+	}
+	else
+	{
+		Undefine(symbol);
+	}
+}
+
+void Emmental::Undefine(SymbolT symbol)
+{
+	std::shared_ptr<EmmentalDefinition> previous = SymbolMap.Exchange(symbol, nullptr);
+
+	if (Cycles)
+		Cycles->Redefined(symbol, previous.get(), nullptr);
+
+	Retire(std::move(previous));
+	DefinitionsChanged();
+}
+
+void Emmental::Retire(std::shared_ptr<EmmentalDefinition>&& definition)
+{
+	// Only definitions being executed are borrowed by the execution path, anything else can be released right away
+	if (definition && std::find(ExecutingDefinitions.begin(), ExecutingDefinitions.end(), definition.get()) != ExecutingDefinitions.end())
+		RetiredDefinitions.push_back(std::move(definition));
+}
+
+void Emmental::RetireAll()
+{
+	for (auto& pair : SymbolMap.Clear())
+		Retire(std::move(pair.second));
+}
+
+void Emmental::FinishExecution()
+{
+	ExecutingDefinitions.pop_back();
+
+	if (ExecutingDefinitions.empty() && !RetiredDefinitions.empty())
+		RetiredDefinitions.clear();
+}
+
+void Emmental::Reset()
+{
+	ClearStack();
+	ClearQueue();
+	ResetDefinitions();
+}
+
+void Emmental::ReportCycle()
+{
+	if (BeginDiagnostic(DiagnosticLimiter::Kind::InfiniteRecursion, 0))
+	{
+		Util::Colorize(ErrorColor, ErrorStream);
+		ErrorStream << "Error: ";
+		Util::Colorize(Util::ConsoleColor::Default, ErrorStream);
+		ErrorStream << "Infinite recursion detected, a definition called itself again with the same state.";
+
+		if (Options.LenientMode)
+			ErrorStream << " Continuing until the recursion limit.";
+
+		ErrorStream << std::endl;
+	}
+
+	if (!Options.LenientMode)
+		throw EmmentalException("Infinite recursion detected.");
+}
+
+void Emmental::SetEffectBarrier(bool enabled) { EffectBarrier = enabled; }
+
+void Emmental::SetCancellationToken(const CancellationToken* token) { Cancellation = token; }
+
+void Emmental::ThrowCancelled() const { throw CancelledException(); }
+
+void Emmental::SetStepMeter(StepMeter* meter)
+{
+	Meter = meter;
+	StepCount = 0;
+	NextMeterCheck = meter ? 0 : ~std::uint64_t();
+}
+
+void Emmental::CheckMeter(std::uint64_t steps)
+{
+	if (Meter)
+		NextMeterCheck = Meter->Check(*this, StepCount + steps);
+}
+
+void Emmental::BeginEffect()
+{
+	if (EffectBarrier)
+		throw EffectBarrierException();
+}
+
+bool Emmental::BeginDiagnostic(DiagnosticLimiter::Kind kind, SymbolT symbol)
+{
+	if (Options.QuietMode)
+		return false;
+
+	BeginEffect();
+	return Diagnostics.Count(kind, symbol);
+}
+
+void Emmental::SummarizeDiagnostics()
+{
+	if (!Options.QuietMode)
+		Diagnostics.Summarize(ErrorStream);
+}
+
+// Memory access used by natives with a static stack effect, so a single body can be instantiated with and without bounds checks
+struct CheckedMemory
+{
+	Emmental* Interpreter;
+	SymbolT Pop() { return Interpreter->PopSymbol(); }
+	void Push(SymbolT item) { Interpreter->Push(item); }
+	SymbolT Dequeue() { return Interpreter->Dequeue(); }
+	void Enqueue(SymbolT item) { Interpreter->Enqueue(item); }
+};
+
+struct UncheckedMemory
+{
+	Emmental* Interpreter;
+	SymbolT Pop() { return Interpreter->PopSymbolUnchecked(); }
+	void Push(SymbolT item) { Interpreter->PushUnchecked(item); }
+	SymbolT Dequeue() { return Interpreter->DequeueUnchecked(); }
+	void Enqueue(SymbolT item) { Interpreter->EnqueueUnchecked(item); }
+};
+
+template<typename Body>
+static std::shared_ptr<NativeDefinition> MakeNative(SymbolT symbol, const StackEffect& effect, Body body)
+{
+	return std::make_shared<NativeDefinition>(symbol, effect,
+		[body](Emmental* interpreter, std::size_t) { CheckedMemory memory = { interpreter }; body(memory); },
+		[body](Emmental* interpreter, std::size_t) { UncheckedMemory memory = { interpreter }; body(memory); });
+}
+
+static DefinitionTable CreateDefaultDefinitions()
+{
+	DefinitionTable defaults;
+
+	// Push NULL to the stack
+	defaults.Set('#', MakeNative('#', StackEffect::Native(0, 1), [](auto& memory) { memory.Push(0); }));
+
+	// 0 through 9 pop a stack symbol, multiply it by ten, add themselves to the multiplied number and push the result to the stack.
+	for (SymbolT i = 0; i <= 9; i++)
+	{
+		defaults.Set('0' + i, MakeNative('0' + i, StackEffect::Native(1, 1), [i](auto& memory)
+		{
+			SymbolT popped = memory.Pop();
+			memory.Push(i + popped * 10);
+		}));
+	}
+
+	// Add two stack symbols and push result to stack
+	defaults.Set('+', MakeNative('+', StackEffect::Native(2, 1), [](auto& memory)
+	{ 
+		memory.Push(memory.Pop() + memory.Pop()); 
+	}));
+	// Subtract first from second stack symbol and push result to stack
+	defaults.Set('-', MakeNative('-', StackEffect::Native(2, 1), [](auto& memory)
+	{ 
+		SymbolT first = memory.Pop();
+		SymbolT second = memory.Pop();
+
+		memory.Push(second - first); 
+	}));
+	// Push discrete log2 (highest set bit) of stack symbol (0 is treated as 2 to the cell width, 256 for 8-bit cells)
+	defaults.Set('~', MakeNative('~', StackEffect::Native(1, 1), [](auto& memory)
+	{ 
+		SymbolT symbol = memory.Pop();
+		SymbolT log2 = 0;
+
+		if (symbol == 0)
+			log2 = memory.Interpreter->GetCellWidth();
+		else
+			while (symbol >>= 1) log2++;
+
+		memory.Push(log2); 
+	}));
+	// Enqueue top stack symbol (doesn't remove it from the stack)
+	defaults.Set('^', MakeNative('^', StackEffect::Native(1, 1, 0, 1), [](auto& memory)
+	{
+		SymbolT symbol = memory.Pop();
+		memory.Enqueue(symbol);
+		memory.Push(symbol);
+	}));
+	// Dequeue to stack
+	defaults.Set('v', MakeNative('v', StackEffect::Native(0, 1, 1, 0), [](auto& memory)
+	{
+		SymbolT symbol = memory.Dequeue();
+		memory.Push(symbol);
+	}));
+	// Duplicate top stack symbol
+	defaults.Set(':', MakeNative(':', StackEffect::Native(1, 2), [](auto& memory)
+	{
+		SymbolT symbol = memory.Pop();
+		memory.Push(symbol);
+		memory.Push(symbol);
+	}));
+	// Pop stack to output
+	defaults.Set('.', MakeNative('.', StackEffect::Native(1, 0), [](auto& memory)
+	{
+		SymbolT symbol = memory.Pop();
+		memory.Interpreter->WriteOutput(symbol);
+	}));
+	// Get input symbol and push to stack
+	defaults.Set(',', MakeNative(',', StackEffect::Native(0, 1), [](auto& memory)
+	{
+		SymbolT symbol = memory.Interpreter->ReadInput();
+		memory.Push(symbol);
+	}));
+	// For convenience, ';' puts ';' on the stack.
+	defaults.Set(';', MakeNative(';', StackEffect::Native(0, 1), [](auto& memory) { memory.Push(';'); }));
+	// Eval: Interpret the top stack symbol
+	defaults.Set('?', std::make_shared<NativeDefinition>('?', [](Emmental* interpreter, std::size_t recursionLevel)
+	{
+		SymbolT symbol = interpreter->PopSymbol();
+		interpreter->Interpret(symbol, recursionLevel);
+	}));
+	
+	// This is the main command of the Emmental: Supplant.
+	// Pop a symbol and a program from the stack. Redefine the symbol as the popped program.
+	defaults.Set('!', std::make_shared<NativeDefinition>('!', [](Emmental* interpreter, std::size_t) { interpreter->Supplant(); }));
+
+	return defaults;
+}
+
+// Built-in definitions are immutable, so a single instance of each is shared by every interpreter
+static const DefinitionTable& GetDefaultDefinitions()
+{
+	static const DefinitionTable defaults = CreateDefaultDefinitions();
+	return defaults;
+}
+
+EmmentalDefinition* Emmental::GetDefinition(SymbolT symbol, const SymbolMapT& state) const
+{
+	auto result = state.find(symbol);
+
+	if (result == state.end())
+		return nullptr;
+
+	return result->second.get();
+}
\ No newline at end of file
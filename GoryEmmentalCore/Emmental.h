@@ -0,0 +1,241 @@
+#pragma once
+#include <istream>
+#include <stack>
+#include <queue>
+#include <map>
+#include <vector>
+#include <memory>
+#include "Config.h"
+#include "NativeDefinition.h"
+#include "Arena.h"
+#include "DefinitionTable.h"
+#include "CancellationToken.h"
+#include "CycleDetector.h"
+#include "ExecutionStats.h"
+#include "DiagnosticLimiter.h"
+#include "SymbolDeque.h"
+
+// Options of a single interpreter. The defaults are copied from Globals.
+struct EmmentalOptions
+{
+	// Read while running, so they can be changed between runs
+	bool LenientMode;
+	bool QuietMode;
+	bool OptimizeProgram;
+	bool IgnoreWhitespace;
+	// Only read when the interpreter is created
+	unsigned int CellWidth;
+	std::size_t MaxStackSize;
+	std::size_t MaxQueueSize;
+	bool DetectCycles;
+
+	EmmentalOptions();
+};
+
+class Emmental;
+
+// Decides whether a run may go on, from the steps its interpreter counted
+class StepMeter
+{
+public:
+	virtual ~StepMeter() = default;
+	// Called with the steps counted so far and the ones about to be executed. Throws to stop the run, or returns the step count to be checked again at.
+	virtual std::uint64_t Check(const Emmental& interpreter, std::uint64_t steps) = 0;
+};
+
+class Emmental
+{
+public:
+	std::istream& InputStream;
+	std::ostream& OutputStream;
+	std::ostream& ErrorStream;
+
+	// Creates a new Emmental interpreter with a specified IO Streams, using the options in Globals
+	Emmental(std::istream& inputStream, std::ostream& outputStream, std::ostream& errorStream);
+	// Creates a new Emmental interpreter with its own options, and the spill directory, statistics and diagnostic limit in Globals
+	Emmental(std::istream& inputStream, std::ostream& outputStream, std::ostream& errorStream, const EmmentalOptions& options);
+
+	// Gets the options of this interpreter. Changing the ones only read on creation has no effect.
+	EmmentalOptions& GetOptions() { return Options; }
+	const EmmentalOptions& GetOptions() const { return Options; }
+
+	// Gets the width of a cell, in bits
+	unsigned int GetCellWidth() const;
+	// Gets the maximum number of symbols on the stack and in the queue
+	std::size_t GetMaxStackSize() const;
+	std::size_t GetMaxQueueSize() const;
+
+	// Gets a copy of the current stack
+	std::stack<SymbolT> GetStack() const;
+	// Gets the number of symbols on the stack
+	std::size_t GetStackSize() const { return ProgramStack.Size(); }
+	// Gets the item on top of the stack and removes it from the stack.
+	SymbolT PopSymbol();
+	// Reads symbols off the stack until ';' is encountered, and returns the symbols in reverse popping order.
+	ProgramT PopProgram();
+	// Same as PopProgram(), reusing the storage of an existing program.
+	void PopProgram(ProgramT& result);
+	// Pushes an item to the top of the stack, truncated to the cell width.
+	void Push(SymbolT item);
+	// Pops all elements off the stack.
+	void ClearStack();
+
+	// Gets a copy of the current queue
+	std::queue<SymbolT> GetQueue() const;
+	// Gets the number of symbols in the queue
+	std::size_t GetQueueSize() const { return ProgramQueue.Size(); }
+	// Storage of the stack, from bottom to top, and of the queue, for code that saves them a segment at a time
+	const SymbolDeque& GetStackStorage() const { return ProgramStack; }
+	const SymbolDeque& GetQueueStorage() const { return ProgramQueue; }
+	// Gets the item at the top of the queue and removes it from the queue.
+	SymbolT Dequeue();
+	// Puts an item at the back of the queue.
+	void Enqueue(SymbolT item);
+	// Dequeues all elements from the queue
+	void ClearQueue();
+
+	// Stack and queue operations without bounds checks. Only valid after CanExecuteUnchecked() succeeded for the executed effect.
+	SymbolT PopSymbolUnchecked();
+	void PushUnchecked(SymbolT item);
+	SymbolT DequeueUnchecked();
+	void EnqueueUnchecked(SymbolT item);
+	// Checks if the stack and queue sizes allow a static effect to execute without any bounds errors. Always fails while detecting cycles or collecting statistics.
+	bool CanExecuteUnchecked(const StackEffect& effect) const;
+
+	// Reads a symbol from the input stream.
+	SymbolT ReadInput();
+	// Checks if the input stream has a symbol buffered, so reading it won't block.
+	bool IsInputAvailable() const;
+	// Writes a symbol to the output stream.
+	void WriteOutput(SymbolT symbol);
+
+	// Gets the current definition of a symbol. Returns nullptr if not defined.
+	std::shared_ptr<EmmentalDefinition> GetDefinition(SymbolT symbol) const;
+	// Gets the current definition of a symbol without sharing its ownership, see Execute(). Returns nullptr if not defined.
+	EmmentalDefinition* BorrowDefinition(SymbolT symbol) const;
+	// Makes a copy of all current definitions
+	SymbolMapT CopyDefinitions() const;
+	// Makes a copy of all current definitions used in a program.
+	SymbolMapT CopyDefinitions(const ProgramT& program) const;
+	// Restores all definitions to their default values, which are shared by all interpreters. Memory of the previous definitions is released in one step.
+	void ResetDefinitions();
+	// Creates an interpreted definition of a program in this interpreter's arena, capturing its symbols from state
+	std::shared_ptr<EmmentalDefinition> CreateDefinition(const ProgramT& program, const SymbolMapT& state);
+	// Pops a symbol and a program from the stack, and redefines the symbol as the program
+	void Supplant();
+	// Moves all current definitions to a new arena generation, releasing the memory left behind by obsolete definitions
+	void CompactDefinitions();
+	// Keeps definitions from being compacted automatically while code outside the execution path borrows them, like the frames of an ExecutionTask
+	// or the breakpoints of a Debugger.
+	// Every HoldDefinitions() must be matched by a ReleaseDefinitions().
+	void HoldDefinitions();
+	void ReleaseDefinitions();
+	// Replaces all current definitions with the selected definitions
+	void SetDefinitions(const SymbolMapT& definitions);
+	// Gets the number of bytes held by interpreted definitions and their captures, in every arena generation still alive
+	std::size_t GetDefinitionBytes() const;
+	// Gets a stamp that changes whenever the current definitions change. Stamps are unique across all interpreters.
+	std::uint64_t GetDefinitionsVersion() const;
+
+	// Executes a symbol using the current interpreter state
+	void Interpret(SymbolT symbol);
+	// Executes a symbol using the current interpreter state and the selected recursion level
+	void Interpret(SymbolT symbol, std::size_t recursionLevel);
+	// Executes a symbol using the selected interpreter state
+	void Interpret(SymbolT symbol, const SymbolMapT& state);
+	// Executes a symbol using the selected interpreter state and the selected recursion level
+	void Interpret(SymbolT symbol, const SymbolMapT& state, std::size_t recursionLevel);
+	// Executes an already resolved definition of a symbol (nullptr if undefined) at the selected recursion level.
+	// The definition is borrowed: it must be owned by the current definitions, or by a captured state of a definition being executed.
+	// Definitions removed from the current definitions while executing are kept alive until the outermost execution finishes.
+	void Execute(EmmentalDefinition* definition, SymbolT symbol, std::size_t recursionLevel);
+
+	// Redefines a symbol
+	void Redefine(SymbolT symbol, std::shared_ptr<EmmentalDefinition> definition);
+
+	// Undefines a symbol
+	void Undefine(SymbolT symbol);
+
+	// Resets definitions, clears the stack and clears the queue.
+	void Reset();
+
+	// Selects a token that stops execution with a CancelledException once cancelled, or nullptr for none.
+	// It's checked every time an interpreted definition is executed, so execution stops within a bounded number of symbols.
+	void SetCancellationToken(const CancellationToken* token);
+	// Throws a CancelledException if the cancellation token was cancelled
+	void CheckCancellation() const { if (Cancellation && Cancellation->IsCancelled()) ThrowCancelled(); }
+
+	// Selects a meter that checks the steps counted from now on, or nullptr for none
+	void SetStepMeter(StepMeter* meter);
+	// Counts steps that are about to be executed. Top-level symbols are counted one by one, and interpreted definitions count all of their steps when called.
+	void CountSteps(std::uint64_t steps) { if (StepCount + steps >= NextMeterCheck) CheckMeter(steps); StepCount += steps; }
+	std::uint64_t GetStepCount() const { return StepCount; }
+
+	// Gets the cycle detector, or nullptr unless cycle detection was enabled when the interpreter was created
+	CycleDetector* GetCycleDetector() const { return Cycles.get(); }
+	// Reports a call found by the cycle detector. Throws an EmmentalException, or only reports it in lenient mode, where the call goes on as usual:
+	// the recursion limit doesn't stop a lenient program, so the recursion may still end.
+	void ReportCycle();
+
+	// Gets the execution statistics, or nullptr unless Globals::CollectStats was set when the interpreter was created.
+	// Every symbol executed through the interpreter is counted by it, the calls an ExecutionTask steps through itself are counted by the task.
+	ExecutionStats* GetStats() const { return Stats.get(); }
+
+	// While enabled, any observable effect (input, output or a printed diagnostic) throws an EffectBarrierException before happening.
+	void SetEffectBarrier(bool enabled);
+
+	// Prints how many repeats of each diagnostic went unprinted because of Globals::DiagnosticLimit, and prints them again afterwards.
+	// Called once a run stops.
+	void SummarizeDiagnostics();
+
+private:
+	bool EffectBarrier = false;
+	const CancellationToken* Cancellation = nullptr;
+	StepMeter* Meter = nullptr;
+	std::uint64_t StepCount = 0;
+	// Step count the meter is checked at, never reached without a meter
+	std::uint64_t NextMeterCheck = ~std::uint64_t();
+	EmmentalOptions Options;
+	std::unique_ptr<CycleDetector> Cycles;
+	unsigned int CellWidth;
+	SymbolT CellMask;
+	std::size_t MaxStackSize;
+	std::size_t MaxQueueSize;
+	SymbolDeque ProgramStack;
+	SymbolDeque ProgramQueue;
+
+	DefinitionTable SymbolMap;
+	std::uint64_t DefinitionsVersion;
+
+	// Bytes held by definitions in every arena generation still alive, including old generations kept by definitions borrowed elsewhere
+	std::shared_ptr<std::size_t> DefinitionBytes;
+	// Arena generation new interpreted definitions are allocated from
+	std::shared_ptr<ArenaGeneration> Arena;
+	// Storage reused by every Supplant()
+	ProgramT SupplantBuffer;
+
+	// Definitions currently being executed, innermost last
+	std::vector<EmmentalDefinition*> ExecutingDefinitions;
+	// Number of holds on the definitions from outside the execution path
+	std::size_t DefinitionHolds = 0;
+	// Definitions that were removed from SymbolMap while executing
+	std::vector<std::shared_ptr<EmmentalDefinition>> RetiredDefinitions;
+	std::unique_ptr<ExecutionStats> Stats;
+	DiagnosticLimiter Diagnostics;
+
+	void BeginEffect();
+	// Begins a diagnostic, which is an effect even if it isn't printed. Returns true if it should be printed.
+	bool BeginDiagnostic(DiagnosticLimiter::Kind kind, SymbolT symbol);
+	[[noreturn]] void ThrowCancelled() const;
+	void CheckMeter(std::uint64_t steps);
+	void DefinitionsChanged();
+	void Retire(std::shared_ptr<EmmentalDefinition>&& definition);
+	void RetireAll();
+	void FinishExecution();
+	void NewArenaGeneration();
+
+	std::shared_ptr<EmmentalDefinition> CreateDefinition(const ProgramT& program, const DefinitionTable& state);
+	// Creates the definition a Supplant() of a program results in. Returns nullptr if the symbol should be undefined.
+	std::shared_ptr<EmmentalDefinition> CompileDefinition(const ProgramT& program, const DefinitionTable& state);
+	EmmentalDefinition* GetDefinition(SymbolT symbol, const SymbolMapT& state) const;
+};
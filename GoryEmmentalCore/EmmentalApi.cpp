@@ -0,0 +1,293 @@
+#include "EmmentalApi.h"
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Emmental.h"
+#include "ExecutionTask.h"
+#include "TopLevel.h"
+#include "CancellationToken.h"
+#include "EmmentalException.h"
+
+// Stream buffer that reads from an input callback
+class CallbackInputBuffer : public std::streambuf
+{
+public:
+	CallbackInputBuffer(emmental_read_callback read, void* context) : Read(read), Context(context) {}
+
+protected:
+	int_type underflow() override
+	{
+		if (gptr() < egptr())
+			return traits_type::to_int_type(*gptr());
+
+		std::size_t count = Read ? Read(Context, Buffer, sizeof(Buffer)) : 0;
+		if (count == 0)
+			return traits_type::eof();
+
+		char* begin = reinterpret_cast<char*>(Buffer);
+		setg(begin, begin, begin + (count < sizeof(Buffer) ? count : sizeof(Buffer)));
+		return traits_type::to_int_type(*gptr());
+	}
+
+private:
+	emmental_read_callback Read;
+	void* Context;
+	unsigned char Buffer[256];
+};
+
+// Stream buffer that writes to an output callback, in blocks
+class CallbackOutputBuffer : public std::streambuf
+{
+public:
+	CallbackOutputBuffer(emmental_write_callback write, void* context) : Write(write), Context(context)
+	{
+		setp(Buffer, Buffer + sizeof(Buffer));
+	}
+
+protected:
+	int_type overflow(int_type c) override
+	{
+		sync();
+
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+
+		return traits_type::not_eof(c);
+	}
+
+	int sync() override
+	{
+		if (Write && pptr() > pbase())
+			Write(Context, pbase(), (std::size_t)(pptr() - pbase()));
+
+		setp(Buffer, Buffer + sizeof(Buffer));
+		return 0;
+	}
+
+private:
+	emmental_write_callback Write;
+	void* Context;
+	char Buffer[256];
+};
+
+struct emmental_interpreter
+{
+	CallbackInputBuffer InputBuffer;
+	CallbackOutputBuffer OutputBuffer;
+	CallbackOutputBuffer ErrorBuffer;
+	std::istream Input;
+	std::ostream Output;
+	std::ostream Error;
+	// Options of this interpreter. The ones only read on creation apply once emmental_reset() recreates it.
+	EmmentalOptions Options;
+	std::unique_ptr<Emmental> Interpreter;
+
+	CancellationToken Cancellation;
+	// Task executing the program fed before it was created, and the program fed since then
+	std::unique_ptr<ExecutionTask> Task;
+	std::vector<char> Pending;
+	std::string LastError;
+
+	emmental_interpreter(emmental_read_callback read, emmental_write_callback write, emmental_write_callback error, void* context)
+		: InputBuffer(read, context), OutputBuffer(write, context), ErrorBuffer(error, context),
+		Input(&InputBuffer), Output(&OutputBuffer), Error(&ErrorBuffer)
+	{
+		// Prompts are written before the input they ask for is read
+		Input.tie(&Output);
+		Recreate();
+	}
+
+	void Recreate()
+	{
+		Interpreter.reset(new Emmental(Input, Output, Error, Options));
+		Interpreter->SetCancellationToken(&Cancellation);
+	}
+};
+
+int emmental_set_option(emmental_interpreter* interpreter, emmental_option option, int64_t value)
+{
+	EmmentalOptions& options = interpreter->Options;
+	EmmentalOptions& current = interpreter->Interpreter->GetOptions();
+
+	switch (option)
+	{
+	case EMMENTAL_OPTION_LENIENT: options.LenientMode = current.LenientMode = value != 0; return 0;
+	case EMMENTAL_OPTION_QUIET: options.QuietMode = current.QuietMode = value != 0; return 0;
+	case EMMENTAL_OPTION_OPTIMIZE: options.OptimizeProgram = current.OptimizeProgram = value != 0; return 0;
+	case EMMENTAL_OPTION_IGNORE_WHITESPACE: options.IgnoreWhitespace = current.IgnoreWhitespace = value != 0; return 0;
+
+	case EMMENTAL_OPTION_CELL_WIDTH:
+		if (value != 8 && value != 16 && value != 32 && value != 64)
+			return -1;
+
+		options.CellWidth = (unsigned int)value;
+		return 0;
+
+	case EMMENTAL_OPTION_DETECT_CYCLES: options.DetectCycles = value != 0; return 0;
+
+	case EMMENTAL_OPTION_STACK_SIZE:
+	case EMMENTAL_OPTION_QUEUE_SIZE:
+		if (value < 0 || (std::uint64_t)value > PTRDIFF_MAX)
+			return -1;
+
+		(option == EMMENTAL_OPTION_STACK_SIZE ? options.MaxStackSize : options.MaxQueueSize) = (std::size_t)value;
+		return 0;
+	}
+
+	return -1;
+}
+
+emmental_interpreter* emmental_create(emmental_read_callback read, emmental_write_callback write, emmental_write_callback error, void* context)
+{
+	try
+	{
+		return new emmental_interpreter(read, write, error, context);
+	}
+	catch (...)
+	{
+		return nullptr;
+	}
+}
+
+void emmental_destroy(emmental_interpreter* interpreter) { delete interpreter; }
+
+int emmental_feed(emmental_interpreter* interpreter, const char* program, size_t size)
+{
+	try
+	{
+		interpreter->Pending.insert(interpreter->Pending.end(), program, program + size);
+	}
+	catch (...)
+	{
+		return -1;
+	}
+
+	return 0;
+}
+
+emmental_status emmental_run(emmental_interpreter* interpreter, uint64_t budget)
+{
+	std::uint64_t remaining = budget == 0 ? ~std::uint64_t() : budget;
+	emmental_status status = EMMENTAL_FINISHED;
+
+	try
+	{
+		while (true)
+		{
+			if (interpreter->Task && interpreter->Task->GetStatus() != ExecutionTask::Status::Finished)
+			{
+				std::uint64_t steps = interpreter->Task->GetStepCount();
+
+				if (interpreter->Task->Run(remaining) == ExecutionTask::Status::Suspended)
+				{
+					status = EMMENTAL_SUSPENDED;
+					break;
+				}
+
+				remaining -= interpreter->Task->GetStepCount() - steps;
+				continue;
+			}
+
+			interpreter->Task.reset();
+			if (interpreter->Pending.empty())
+				break;
+
+			// Nothing suspends without a budget, so the program runs compiled instead of a step at a time
+			if (budget == 0)
+			{
+				std::vector<char> program;
+				program.swap(interpreter->Pending);
+				interpreter->Interpreter->CheckCancellation();
+				TopLevel::Interpret(*interpreter->Interpreter, program.data(), program.size());
+				continue;
+			}
+
+			interpreter->Task.reset(new ExecutionTask(*interpreter->Interpreter, interpreter->Pending.data(), interpreter->Pending.size()));
+			interpreter->Pending.clear();
+		}
+	}
+	catch (const CancelledException&)
+	{
+		interpreter->Cancellation.Reset();
+		status = EMMENTAL_CANCELLED;
+	}
+	catch (const std::exception& exception)
+	{
+		interpreter->LastError = exception.what();
+		status = EMMENTAL_ERROR;
+	}
+
+	if (status == EMMENTAL_CANCELLED || status == EMMENTAL_ERROR)
+	{
+		interpreter->Task.reset();
+		interpreter->Pending.clear();
+	}
+
+	// Diagnostics held back by the limit are summarized once the fed program stopped
+	if (status != EMMENTAL_SUSPENDED)
+		interpreter->Interpreter->SummarizeDiagnostics();
+
+	interpreter->Output.flush();
+	interpreter->Error.flush();
+	return status;
+}
+
+void emmental_cancel(emmental_interpreter* interpreter) { interpreter->Cancellation.Cancel(); }
+
+const char* emmental_last_error(const emmental_interpreter* interpreter) { return interpreter->LastError.c_str(); }
+
+size_t emmental_get_stack(const emmental_interpreter* interpreter, uint64_t* buffer, size_t capacity)
+{
+	std::stack<SymbolT> stack = interpreter->Interpreter->GetStack();
+	std::size_t size = stack.size();
+
+	// Popping goes from the top down
+	for (std::size_t i = size; i > 0; i--)
+	{
+		if (i - 1 < capacity)
+			buffer[i - 1] = stack.top();
+
+		stack.pop();
+	}
+
+	return size;
+}
+
+size_t emmental_get_queue(const emmental_interpreter* interpreter, uint64_t* buffer, size_t capacity)
+{
+	std::queue<SymbolT> queue = interpreter->Interpreter->GetQueue();
+	std::size_t size = queue.size();
+
+	for (std::size_t i = 0; i < size; i++)
+	{
+		if (i < capacity)
+			buffer[i] = queue.front();
+
+		queue.pop();
+	}
+
+	return size;
+}
+
+void emmental_reset(emmental_interpreter* interpreter)
+{
+	interpreter->Task.reset();
+	interpreter->Pending.clear();
+
+	try
+	{
+		interpreter->Recreate();
+	}
+	catch (...)
+	{
+		// Out of memory keeps the options the interpreter was created with
+		interpreter->Interpreter->Reset();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Stable C interface to the interpreter, for embedding it in other programs and languages.
+// Functions never throw. Every interpreter must only be used by one thread at a time, except for emmental_cancel().
+
+#if defined(_WIN32) && defined(EMMENTAL_SHARED)
+#	ifdef EMMENTAL_EXPORTS
+#		define EMMENTAL_API __declspec(dllexport)
+#	else
+#		define EMMENTAL_API __declspec(dllimport)
+#	endif
+#elif defined(EMMENTAL_SHARED)
+#	define EMMENTAL_API __attribute__((visibility("default")))
+#else
+#	define EMMENTAL_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct emmental_interpreter emmental_interpreter;
+
+typedef enum emmental_option
+{
+	// Same as the command line options. Every interpreter has its own options, and these apply from its next run.
+	EMMENTAL_OPTION_LENIENT,
+	EMMENTAL_OPTION_QUIET,
+	EMMENTAL_OPTION_OPTIMIZE,
+	EMMENTAL_OPTION_IGNORE_WHITESPACE,
+	// Only apply once emmental_reset() clears the interpreter
+	EMMENTAL_OPTION_CELL_WIDTH,
+	EMMENTAL_OPTION_DETECT_CYCLES,
+	EMMENTAL_OPTION_STACK_SIZE,
+	EMMENTAL_OPTION_QUEUE_SIZE
+} emmental_option;
+
+typedef enum emmental_status
+{
+	// Every fed symbol was executed
+	EMMENTAL_FINISHED,
+	// The step budget ran out, emmental_run() continues where execution stopped
+	EMMENTAL_SUSPENDED,
+	// An error stopped execution, see emmental_last_error(). The rest of the fed program is skipped.
+	EMMENTAL_ERROR,
+	// emmental_cancel() stopped execution. The rest of the fed program is skipped.
+	EMMENTAL_CANCELLED
+} emmental_status;
+
+// Reads up to capacity bytes of input into buffer. Returns the number of bytes read, 0 at the end of the input.
+typedef size_t (*emmental_read_callback)(void* context, unsigned char* buffer, size_t capacity);
+// Writes size bytes of output or of error messages
+typedef void (*emmental_write_callback)(void* context, const char* data, size_t size);
+
+// Creates an interpreter with the default definitions and options, or returns NULL if out of memory. Any callback may be NULL: input is then empty, and output is discarded.
+EMMENTAL_API emmental_interpreter* emmental_create(emmental_read_callback read, emmental_write_callback write, emmental_write_callback error, void* context);
+EMMENTAL_API void emmental_destroy(emmental_interpreter* interpreter);
+// Sets an option of an interpreter. Returns 0, or -1 if the option or value is invalid.
+EMMENTAL_API int emmental_set_option(emmental_interpreter* interpreter, emmental_option option, int64_t value);
+
+// Appends program bytes to execute, after everything fed before. Returns 0, or -1 if out of memory.
+EMMENTAL_API int emmental_feed(emmental_interpreter* interpreter, const char* program, size_t size);
+// Executes at most budget steps of the fed program, 0 for no limit. A step is a symbol of the program, of a definition, or evaluated by '?'.
+EMMENTAL_API emmental_status emmental_run(emmental_interpreter* interpreter, uint64_t budget);
+// Stops the current run as soon as possible, or the next one if none is running. Safe to call from any thread, or from a signal handler.
+EMMENTAL_API void emmental_cancel(emmental_interpreter* interpreter);
+// Gets the message of the error of the last run that returned EMMENTAL_ERROR
+EMMENTAL_API const char* emmental_last_error(const emmental_interpreter* interpreter);
+
+// Copies up to capacity stack items into buffer, from the bottom up, and returns the size of the stack
+EMMENTAL_API size_t emmental_get_stack(const emmental_interpreter* interpreter, uint64_t* buffer, size_t capacity);
+// Copies up to capacity queue items into buffer, from the front to the back, and returns the size of the queue
+EMMENTAL_API size_t emmental_get_queue(const emmental_interpreter* interpreter, uint64_t* buffer, size_t capacity);
+// Restores the default definitions and clears the stack and the queue, applying every option set since the interpreter was created
+EMMENTAL_API void emmental_reset(emmental_interpreter* interpreter);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include "StackEffect.h"
+
+class EmmentalDefinition
+{
+public:
+	virtual void Execute(class Emmental* interpreter, std::size_t recursionLevel) = 0;
+	// Gets the static stack and queue effect of this definition, or nullptr if it depends on the interpreter state
+	virtual const StackEffect* GetStackEffect() const { return nullptr; }
+	// Gets a hash of what the definition executes. Definitions with equal contents behave the same, even if created separately.
+	virtual std::uint64_t GetContentHash() const = 0;
+
+	// Cheaper than a dynamic_cast, for code that classifies every symbol of a program
+	virtual const class NativeDefinition* AsNative() const { return nullptr; }
+	virtual const class InterpretedDefinition* AsInterpreted() const { return nullptr; }
+
+	// Stops the definition from updating any internal cache, so several interpreters can execute it at once.
+	// Must be called before the definition is shared between threads.
+	virtual void Freeze() {}
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <exception>
+class EmmentalException : public std::exception
+{
+public:
+	EmmentalException(const char* const message) : Message(message) {}
+	virtual const char* what() const override { return Message; }
+
+private:
+	const char* const Message;
+};
+
+// Thrown when an observable effect is attempted while the interpreter's effect barrier is enabled.
+class EffectBarrierException : public EmmentalException
+{
+public:
+	EffectBarrierException() : EmmentalException("Observable effect attempted while effect barrier is enabled.") {}
+};
+
+
+// Thrown when the interpreter's cancellation token was cancelled. The stack, queue and definitions are left as they were when execution stopped.
+class CancelledException : public EmmentalException
+{
+public:
+	CancelledException() : EmmentalException("Execution cancelled.") {}
+};
\ No newline at end of file
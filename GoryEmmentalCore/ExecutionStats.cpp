@@ -0,0 +1,63 @@
+#include "ExecutionStats.h"
+#include <iomanip>
+#include <algorithm>
+#include "NativeDefinition.h"
+
+// Every executed symbol is either a primitive or a definition call
+static double GetSymbolsPerSecond(const ExecutionStats& stats, double seconds)
+{
+	return seconds > 0 ? (stats.PrimitivesExecuted + stats.DefinitionsInvoked) / seconds : 0;
+}
+
+void ExecutionStats::Executed(const EmmentalDefinition* definition, std::size_t recursionLevel)
+{
+	const NativeDefinition* native = definition ? definition->AsNative() : nullptr;
+
+	if (native)
+		PrimitivesExecuted++;
+	else if (definition)
+		DefinitionsInvoked++;
+
+	if (native && native->GetSymbol() == '!')
+		Supplants++;
+
+	PeakRecursionLevel = std::max(PeakRecursionLevel, recursionLevel);
+}
+
+void ExecutionStats::Resized(std::size_t stackSize, std::size_t queueSize)
+{
+	PeakStackSize = std::max(PeakStackSize, stackSize);
+	PeakQueueSize = std::max(PeakQueueSize, queueSize);
+}
+
+void ExecutionStats::Print(std::ostream& output, double seconds) const
+{
+	output << "Statistics:" << std::endl;
+	output << "  Primitives executed:  " << PrimitivesExecuted << std::endl;
+	output << "  Definitions invoked:  " << DefinitionsInvoked << std::endl;
+	output << "  Supplants:            " << Supplants << std::endl;
+	output << "  Definition bytes:     " << DefinitionBytes << std::endl;
+	output << "  Peak stack depth:     " << PeakStackSize << " of " << MaxStackSize << std::endl;
+	output << "  Peak queue depth:     " << PeakQueueSize << " of " << MaxQueueSize << std::endl;
+	output << "  Peak recursion level: " << PeakRecursionLevel << " of " << EMMENTAL_MAX_RECURSION_LEVEL << std::endl;
+	output << "  Wall time:            " << std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+	output << "  Symbols per second:   " << std::setprecision(0) << GetSymbolsPerSecond(*this, seconds) << std::endl;
+	output << std::defaultfloat << std::setprecision(6);
+}
+
+void ExecutionStats::PrintJson(std::ostream& output, double seconds) const
+{
+	output << "{\"primitives_executed\":" << PrimitivesExecuted
+		<< ",\"definitions_invoked\":" << DefinitionsInvoked
+		<< ",\"supplants\":" << Supplants
+		<< ",\"definition_bytes\":" << DefinitionBytes
+		<< ",\"peak_stack_depth\":" << PeakStackSize
+		<< ",\"max_stack_depth\":" << MaxStackSize
+		<< ",\"peak_queue_depth\":" << PeakQueueSize
+		<< ",\"max_queue_depth\":" << MaxQueueSize
+		<< ",\"peak_recursion_level\":" << PeakRecursionLevel
+		<< ",\"max_recursion_level\":" << EMMENTAL_MAX_RECURSION_LEVEL
+		<< std::fixed << std::setprecision(6) << ",\"wall_seconds\":" << seconds
+		<< std::setprecision(0) << ",\"symbols_per_second\":" << GetSymbolsPerSecond(*this, seconds)
+		<< "}" << std::endl;
+}
\ No newline at end of file
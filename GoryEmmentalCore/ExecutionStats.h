@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include "Config.h"
+#include "EmmentalDefinition.h"
+
+// Counters of what a run executed. They're kept by an interpreter created while Globals::CollectStats is set, and updated by it for every
+// symbol it executes, and by an ExecutionTask for the calls it steps through itself, so interpreters that don't collect them never touch them.
+struct ExecutionStats
+{
+	// Symbols executed by natives and by interpreted definitions
+	std::uint64_t PrimitivesExecuted = 0;
+	std::uint64_t DefinitionsInvoked = 0;
+	std::uint64_t Supplants = 0;
+	// Bytes allocated for interpreted definitions and their captures, including the ones released since
+	std::uint64_t DefinitionBytes = 0;
+	std::size_t PeakStackSize = 0;
+	std::size_t PeakQueueSize = 0;
+	std::size_t PeakRecursionLevel = 0;
+	std::size_t MaxStackSize;
+	std::size_t MaxQueueSize;
+
+	ExecutionStats(std::size_t maxStackSize, std::size_t maxQueueSize) : MaxStackSize(maxStackSize), MaxQueueSize(maxQueueSize) {}
+
+	// Records a symbol executed at a recursion level, with its definition or nullptr if it's undefined
+	void Executed(const EmmentalDefinition* definition, std::size_t recursionLevel);
+	// Records the stack and queue sizes after a step. Natives pop everything before they push, so their peaks are reached after them.
+	void Resized(std::size_t stackSize, std::size_t queueSize);
+
+	// Prints a report of a run that took the given wall-clock time, as aligned text or as a JSON object
+	void Print(std::ostream& output, double seconds) const;
+	void PrintJson(std::ostream& output, double seconds) const;
+};
\ No newline at end of file
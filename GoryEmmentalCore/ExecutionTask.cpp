@@ -0,0 +1,258 @@
+#include "ExecutionTask.h"
+#include <cctype>
+#include "NativeDefinition.h"
+
+ExecutionTask::ExecutionTask(Emmental& interpreter, const char* program, std::size_t size)
+	: Interpreter(interpreter), Program(program, program + size)
+{
+}
+
+ExecutionTask::~ExecutionTask()
+{
+	while (!Frames.empty())
+		PopFrame();
+}
+
+ExecutionTask::Status ExecutionTask::Run(std::uint64_t budget)
+{
+	if (CurrentStatus == Status::Finished)
+		return CurrentStatus;
+
+	try
+	{
+		Interpreter.CheckCancellation();
+
+		while (budget > 0)
+		{
+			std::uint64_t steps;
+
+			if (HasPendingEval)
+			{
+				// The evaluated symbol may be a '?' itself, which sets the next pending symbol
+				HasPendingEval = false;
+				steps = Step(Interpreter.BorrowDefinition(PendingEval), true, PendingEval, PendingEvalLevel, budget);
+
+				if (!steps)
+					HasPendingEval = true;
+			}
+			else
+			{
+				// Finished frames don't take a step
+				while (!Frames.empty() && Frames.back().Position == Frames.back().Definition->GetProgramSize())
+					PopFrame();
+
+				if (Frames.empty())
+				{
+					if (Position == Program.size())
+						return CurrentStatus = Status::Finished;
+
+					SymbolT symbol = (unsigned char)Program[Position];
+
+					if (Interpreter.GetOptions().IgnoreWhitespace && std::isspace((unsigned char)symbol))
+					{
+						Position++;
+						continue;
+					}
+
+					steps = Step(Interpreter.BorrowDefinition(symbol), true, symbol, 0, budget);
+					if (steps)
+						Position++;
+				}
+				else
+				{
+					// The step may push a frame, so the position is advanced through the index
+					std::size_t index = Frames.size() - 1;
+					SymbolT symbol = Frames[index].Definition->GetProgramSymbol(Frames[index].Position);
+
+					steps = Step(Frames[index].Definition->GetCapture(symbol), false, symbol, Frames[index].RecursionLevel, budget);
+					if (steps)
+						Frames[index].Position++;
+				}
+			}
+
+			if (!steps)
+				return CurrentStatus = Status::WaitingForInput;
+
+			budget -= steps;
+			StepCount += steps;
+		}
+	}
+	catch (...)
+	{
+		while (!Frames.empty())
+			PopFrame();
+
+		HasPendingEval = false;
+		CurrentStatus = Status::Finished;
+		throw;
+	}
+
+	return CurrentStatus = Status::Suspended;
+}
+
+std::uint64_t ExecutionTask::Step(EmmentalDefinition* definition, bool global, SymbolT symbol, std::size_t recursionLevel, std::uint64_t budget)
+{
+	const InterpretedDefinition* interpreted = definition ? definition->AsInterpreted() : nullptr;
+	const NativeDefinition* native = definition ? definition->AsNative() : nullptr;
+
+	// Checked first, so a step that waits for input isn't counted in the statistics
+	if (native && native->GetSymbol() == ',' && SuspendOnInput && !Interpreter.IsInputAvailable() && recursionLevel < EMMENTAL_MAX_RECURSION_LEVEL)
+		return 0;
+
+	// Symbols executed by the interpreter are counted in the statistics by it, the ones the task steps through itself are counted here
+	ExecutionStats* stats = Interpreter.GetStats();
+
+	// Undefined symbols and the recursion limit are reported by the interpreter itself
+	if (recursionLevel >= EMMENTAL_MAX_RECURSION_LEVEL || !definition)
+	{
+		Interpreter.Execute(definition, symbol, recursionLevel);
+		return 1;
+	}
+
+	if (interpreted)
+	{
+		// A definition with a static effect only executes natives, and can't wait for input unless it reads it.
+		// If the budget covers all of them, it's executed in one go by the interpreter, without a frame, unless its symbols are counted one by one.
+		if (interpreted->GetStackEffect() && !SuspendOnInput && interpreted->GetStepCount() < budget && !stats)
+		{
+			Interpreter.Execute(definition, symbol, recursionLevel);
+			return interpreted->GetStepCount() + 1;
+		}
+
+		// Calls don't go through the interpreter, so they check for cancellation and cycles themselves
+		Interpreter.CheckCancellation();
+
+		if (stats)
+			stats->Executed(definition, recursionLevel);
+
+		CycleDetector* cycles = interpreted->GetStackEffect() ? nullptr : Interpreter.GetCycleDetector();
+		std::uint64_t cycleKey = 0;
+
+		// In lenient mode, the call goes on without being recorded
+		if (cycles && !cycles->Enter(interpreted, cycleKey))
+		{
+			Interpreter.ReportCycle();
+			cycles = nullptr;
+		}
+
+		// The current definitions may drop a definition looked up in them before its frame finishes, captures are kept alive by the frame below
+		PushFrame({ interpreted, global ? Interpreter.GetDefinition(symbol) : nullptr, 0, recursionLevel + 1, cycles != nullptr, cycleKey });
+		return 1;
+	}
+
+	if (native->GetSymbol() == '?')
+	{
+		if (stats)
+			stats->Executed(definition, recursionLevel);
+
+		// Same as the '?' native, but the evaluated symbol is executed as the next step, so it can wait for input and run in a frame of the task
+		PendingEval = Interpreter.PopSymbol();
+		PendingEvalLevel = recursionLevel + 1;
+		HasPendingEval = true;
+		return 1;
+	}
+
+	Interpreter.Execute(definition, symbol, recursionLevel);
+	return 1;
+}
+
+bool ExecutionTask::PeekStep(NextStep& next) const
+{
+	if (CurrentStatus == Status::Finished)
+		return false;
+
+	// Positions inside calls are already past the symbol that made them
+	std::size_t callPosition = Position - 1;
+
+	if (HasPendingEval)
+	{
+		next = { PendingEval, Interpreter.BorrowDefinition(PendingEval), nullptr, 0, callPosition, PendingEvalLevel };
+		return true;
+	}
+
+	// Finished frames are popped by the next Run() without taking a step
+	std::size_t depth = Frames.size();
+	while (depth > 0 && Frames[depth - 1].Position == Frames[depth - 1].Definition->GetProgramSize())
+		depth--;
+
+	if (depth > 0)
+	{
+		const Frame& frame = Frames[depth - 1];
+		SymbolT symbol = frame.Definition->GetProgramSymbol(frame.Position);
+		next = { symbol, frame.Definition->GetCapture(symbol), frame.Definition, frame.Position, callPosition, frame.RecursionLevel };
+		return true;
+	}
+
+	std::size_t position = Position;
+	while (position < Program.size() && Interpreter.GetOptions().IgnoreWhitespace && std::isspace((unsigned char)Program[position]))
+		position++;
+
+	if (position == Program.size())
+		return false;
+
+	SymbolT symbol = (unsigned char)Program[position];
+	next = { symbol, Interpreter.BorrowDefinition(symbol), nullptr, 0, position, 0 };
+	return true;
+}
+
+void ExecutionTask::PushFrame(const Frame& frame)
+{
+	// Frames borrow definitions between steps, so they must not be compacted until the task is back at the top level
+	if (Frames.empty())
+		Interpreter.HoldDefinitions();
+
+	Frames.push_back(frame);
+}
+
+void ExecutionTask::PopFrame()
+{
+	if (Frames.back().CycleTracked)
+		Interpreter.GetCycleDetector()->Leave(Frames.back().CycleKey);
+
+	Frames.pop_back();
+
+	if (Frames.empty())
+		Interpreter.ReleaseDefinitions();
+}
+
+ExecutionTask::Status ExecutionTask::GetStatus() const { return CurrentStatus; }
+
+std::uint64_t ExecutionTask::GetStepCount() const { return StepCount; }
+
+void ExecutionTask::SetSuspendOnInput(bool enabled) { SuspendOnInput = enabled; }
+
+ExecutionTask::Progress ExecutionTask::GetProgress() const
+{
+	Progress progress{ Position, StepCount, {}, HasPendingEval, PendingEval, PendingEvalLevel };
+
+	for (std::size_t i = 0; i < Frames.size(); i++)
+	{
+		std::shared_ptr<EmmentalDefinition> definition = Frames[i].Owner;
+
+		// A capture is called by the symbol just before the position of the calling frame
+		if (!definition)
+		{
+			const InterpretedDefinition* caller = Frames[i - 1].Definition;
+			definition = caller->GetDefinitions().at(caller->GetProgramSymbol(Frames[i - 1].Position - 1));
+		}
+
+		progress.Calls.push_back({ definition, Frames[i].Position, Frames[i].RecursionLevel });
+	}
+
+	return progress;
+}
+
+void ExecutionTask::SetProgress(const Progress& progress)
+{
+	Position = progress.Position;
+	StepCount = progress.StepCount;
+	HasPendingEval = progress.HasPendingEval;
+	PendingEval = progress.PendingEval;
+	PendingEvalLevel = progress.PendingEvalLevel;
+	while (!Frames.empty())
+		PopFrame();
+
+	// Every restored frame owns its definition, instead of relying on the captures of the frame below
+	for (const Call& call : progress.Calls)
+		PushFrame({ call.Definition->AsInterpreted(), call.Definition, call.Position, call.RecursionLevel, false, 0 });
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Config.h"
+#include "Emmental.h"
+#include "InterpretedDefinition.h"
+
+// Executes a program in slices of a bounded number of steps. Unlike Emmental::Interpret(), which recurses until a symbol is done,
+// a task keeps its calls in its own frames, so it can be suspended after any step and resumed later, and many tasks can share one thread.
+class ExecutionTask
+{
+public:
+	enum class Status
+	{
+		// The step budget ran out, Run() continues where execution stopped
+		Suspended,
+		// The next step is a ',' and no input is available, Run() retries it
+		WaitingForInput,
+		// The whole program was executed
+		Finished
+	};
+
+	// Creates a task that executes the program text in [program, program + size) with an interpreter, which must outlive the task
+	ExecutionTask(Emmental& interpreter, const char* program, std::size_t size);
+	// Calls the task was still executing are abandoned
+	~ExecutionTask();
+
+	// Executes at most budget steps: symbols of the program, of a definition being executed, or evaluated by '?'.
+	// Errors are thrown as in Emmental::Interpret(), and finish the task.
+	Status Run(std::uint64_t budget);
+	Status GetStatus() const;
+	// Gets the number of steps executed so far
+	std::uint64_t GetStepCount() const;
+
+	// The step the next Run() executes first
+	struct NextStep
+	{
+		SymbolT Symbol;
+		// Definition the symbol resolves to, nullptr if undefined
+		EmmentalDefinition* Definition;
+		// Definition the symbol is part of and its position in it, nullptr for a symbol of the program or evaluated by '?'
+		const InterpretedDefinition* Caller;
+		std::size_t CallerPosition;
+		// Position in the program of the symbol, or of the call it's executed in
+		std::size_t Position;
+		std::size_t RecursionLevel;
+	};
+
+	// Gets the step the next Run() executes first, without executing anything. Returns false if the program has no steps left.
+	bool PeekStep(NextStep& next) const;
+
+	// A call the task is executing
+	struct Call
+	{
+		std::shared_ptr<EmmentalDefinition> Definition;
+		// Position of the next symbol of the definition to execute
+		std::size_t Position;
+		std::size_t RecursionLevel;
+	};
+
+	// Where a task is in its execution, which can be restored into a new task for the same program
+	struct Progress
+	{
+		std::size_t Position;
+		std::uint64_t StepCount;
+		// Outermost call first
+		std::vector<Call> Calls;
+		bool HasPendingEval;
+		SymbolT PendingEval;
+		std::size_t PendingEvalLevel;
+	};
+
+	// Gets the progress of a task between runs
+	Progress GetProgress() const;
+	// Continues from the progress of another task. Only valid before the task first runs, and while not detecting cycles.
+	void SetProgress(const Progress& progress);
+
+	// While enabled, ',' suspends the task with WaitingForInput instead of blocking when the input stream has no symbol buffered.
+	// Disable it once the input is complete, so ',' reads its end.
+	void SetSuspendOnInput(bool enabled);
+
+private:
+	struct Frame
+	{
+		const InterpretedDefinition* Definition;
+		// Set if the definition was looked up in the current definitions
+		std::shared_ptr<EmmentalDefinition> Owner;
+		std::size_t Position;
+		std::size_t RecursionLevel;
+		// Set if the frame was recorded by the cycle detector, with the key to remove it with
+		bool CycleTracked;
+		std::uint64_t CycleKey;
+	};
+
+	Emmental& Interpreter;
+	// Program text is made of bytes, so it's kept as bytes instead of symbols
+	std::vector<char> Program;
+	std::size_t Position = 0;
+	std::vector<Frame> Frames;
+	Status CurrentStatus = Status::Suspended;
+	std::uint64_t StepCount = 0;
+	bool SuspendOnInput = false;
+
+	// Symbol popped by a '?', executed by the next step
+	bool HasPendingEval = false;
+	SymbolT PendingEval = 0;
+	std::size_t PendingEvalLevel = 0;
+
+	// Executes a symbol found in the current definitions (global) or in a capture, or pushes a frame for it if it's interpreted.
+	// Returns the steps taken, at most budget, or 0 without any effect if it has to wait for input.
+	std::uint64_t Step(EmmentalDefinition* definition, bool global, SymbolT symbol, std::size_t recursionLevel, std::uint64_t budget);
+	// Frames are only added and removed through these, which hold the interpreter's definitions while there's any
+	void PushFrame(const Frame& frame);
+	void PopFrame();
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "FileReplacement.h"
+#include <atomic>
+#include <cstdio>
+
+#if _WIN32
+#	include <process.h>
+#	include <Windows.h>
+#else
+#	include <cstdlib>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/stat.h>
+#endif
+
+namespace FileReplacement
+{
+	std::string CreateTemporary(const std::string& path)
+	{
+#if _WIN32
+		// The process id keeps other processes away, and the counter other threads
+		static std::atomic<unsigned int> counter(0);
+
+		for (unsigned int attempt = 0; attempt < 100; attempt++)
+		{
+			std::string temporaryPath = path + "." + std::to_string(_getpid()) + "." + std::to_string(counter++) + ".tmp";
+
+			HANDLE file = CreateFileA(temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(file);
+				return temporaryPath;
+			}
+
+			if (GetLastError() != ERROR_FILE_EXISTS)
+				break;
+		}
+
+		return std::string();
+#else
+		std::string temporaryPath = path + ".XXXXXX";
+
+		int descriptor = mkstemp(&temporaryPath[0]);
+		if (descriptor < 0)
+			return std::string();
+
+		// mkstemp() only lets the owner read it, other runs should be able to read the file it replaces like any other
+		fchmod(descriptor, 0644);
+		close(descriptor);
+		return temporaryPath;
+#endif
+	}
+
+	bool Replace(const std::string& source, const std::string& target)
+	{
+#if _WIN32
+		return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		if (std::rename(source.c_str(), target.c_str()) != 0)
+			return false;
+
+		// The rename is only on the disk once its directory is
+		std::string::size_type slash = target.find_last_of('/');
+		std::string directory = slash == std::string::npos ? "." : target.substr(0, slash + 1);
+
+		int descriptor = open(directory.c_str(), O_RDONLY);
+		if (descriptor >= 0)
+		{
+			fsync(descriptor);
+			close(descriptor);
+		}
+
+		return true;
+#endif
+	}
+}
\ No newline at end of file
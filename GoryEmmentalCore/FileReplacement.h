@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+// Replaces files by writing a temporary file next to them first, so readers and crashes only ever see the old or the new contents
+namespace FileReplacement
+{
+	// Creates an empty temporary file next to a path, with a name no other process uses, and returns its path.
+	// Returns an empty string if it can't be created.
+	std::string CreateTemporary(const std::string& path);
+	// Replaces a file with another in one step, without removing it first, and makes the replacement durable
+	bool Replace(const std::string& source, const std::string& target);
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Globals.h"
+#include "Config.h"
 
 #if _WIN32
 #	include <Windows.h>
@@ -13,6 +14,17 @@ bool Globals::OptimizeProgram = false;
 bool Globals::IgnoreWhitespace = false;
 bool Globals::QuietMode = false;
 bool Globals::LenientMode = false;
+std::string Globals::CacheDirectory;
+unsigned int Globals::CellWidth = 8;
+std::size_t Globals::MaxStackSize = EMMENTAL_MAX_STACK_SIZE;
+std::size_t Globals::MaxQueueSize = EMMENTAL_MAX_QUEUE_SIZE;
+std::string Globals::SpillDirectory;
+std::uint64_t Globals::MaxSteps = 0;
+std::uint64_t Globals::MaxMilliseconds = 0;
+std::uint64_t Globals::MaxDefinitionBytes = 0;
+bool Globals::DetectCycles = false;
+bool Globals::CollectStats = false;
+std::uint64_t Globals::DiagnosticLimit = 0;
 
 #if _WIN32
 static bool TryEnableWin32Color()
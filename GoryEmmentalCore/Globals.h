@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Globals
+{
+	extern bool DebugMode;
+	extern bool UseVirtualConsole;
+	extern bool OptimizeProgram;
+	extern bool IgnoreWhitespace;
+	extern bool QuietMode;
+	extern bool LenientMode;
+	extern std::string CacheDirectory;
+	extern unsigned int CellWidth;
+	// Limits of the stack and queue, in symbols
+	extern std::size_t MaxStackSize;
+	extern std::size_t MaxQueueSize;
+	// Directory for the scratch files large stacks and queues spill to, empty to keep them in memory
+	extern std::string SpillDirectory;
+	// Quotas of a run, 0 if unlimited
+	extern std::uint64_t MaxSteps;
+	extern std::uint64_t MaxMilliseconds;
+	extern std::uint64_t MaxDefinitionBytes;
+	// Only applies to interpreters created afterwards
+	extern bool DetectCycles;
+	// Counts what interpreters execute, only applies to interpreters created afterwards
+	extern bool CollectStats;
+	// Times each distinct warning or error is printed before its repeats are only counted, 0 for no limit.
+	// Only applies to interpreters created afterwards.
+	extern std::uint64_t DiagnosticLimit;
+
+	void Initialize();
+}
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "InterpretedDefinition.h"
+#include <algorithm>
+#include "NativeDefinition.h"
+#include "Emmental.h"
+#include "SymbolSet.h"
+#include "CycleDetector.h"
+
+// Keeps a definition recorded as executing by a cycle detector, if any, while in scope
+class CycleGuard
+{
+public:
+	explicit CycleGuard(CycleDetector* detector) : Detector(detector), Key(0) {}
+	~CycleGuard() { if (Detector) Detector->Leave(Key); }
+
+	// Returns false if the definition is already executing with the same state, in which case it isn't recorded
+	bool Enter(const EmmentalDefinition* definition)
+	{
+		if (Detector && !Detector->Enter(definition, Key))
+		{
+			Detector = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+
+private:
+	CycleDetector* Detector;
+	std::uint64_t Key;
+};
+
+static bool IsEval(const EmmentalDefinition* definition)
+{
+	const NativeDefinition* native = definition ? definition->AsNative() : nullptr;
+	return native && native->GetSymbol() == '?';
+}
+
+InterpretedDefinition::InterpretedDefinition(const ProgramT& program, const DefinitionTable& state, const ArenaAllocator<char>& allocator)
+	: InterpretedDefinition(program, state, allocator, Measure(program, state))
+{
+}
+
+InterpretedDefinition::InterpretedDefinition(const ProgramT& program, const DefinitionTable& state, const ArenaAllocator<char>& allocator, const Size& size)
+	: Program(program.size() * size.ProgramCellBytes, allocator), ProgramCellBytes(size.ProgramCellBytes), Captures(program.size(), allocator),
+	Steps(size.Steps, allocator), Origins(size.Steps, allocator), EvalCaches(size.Evals, allocator), MaxDepth(0), HasStaticEffect(true), ContentHash(0)
+{
+	SymbolSet captured;
+
+	for (SymbolT symbol : program)
+	{
+		unsigned char cell[sizeof(SymbolT)];
+		SymbolCells::Store(cell, ProgramCellBytes, 0, symbol);
+		for (std::size_t i = 0; i < ProgramCellBytes; i++)
+			Program.PushBack(cell[i]);
+
+		EmmentalDefinition* definition = state.Get(symbol);
+		if (definition && captured.Insert(symbol))
+		{
+			Captures.PushBack(std::make_pair(symbol, state.GetShared(symbol)));
+			ContentHash = CycleDetector::Mix(ContentHash, definition->GetContentHash());
+		}
+
+		ContentHash = CycleDetector::Mix(ContentHash, symbol);
+
+		const InterpretedDefinition* inlined = GetInlinable(definition, Steps.size());
+		if (inlined)
+		{
+			for (std::size_t i = 0; i < inlined->Steps.size(); i++)
+				AddStep(inlined->Steps[i].Definition, inlined->Origins[i].Symbol, inlined->Origins[i].Depth + 1);
+		}
+		else
+		{
+			AddStep(definition, symbol, 0);
+		}
+	}
+}
+
+void InterpretedDefinition::AddStep(EmmentalDefinition* definition, SymbolT symbol, std::size_t depth)
+{
+	const NativeDefinition* native = definition ? definition->AsNative() : nullptr;
+
+	EvalCache* cache = nullptr;
+	if (native && native->GetSymbol() == '?')
+	{
+		EvalCaches.PushBack(EvalCache());
+		cache = &EvalCaches[EvalCaches.size() - 1];
+	}
+
+	Steps.PushBack({ definition, cache });
+	Origins.PushBack({ symbol, depth });
+
+	if (depth > MaxDepth)
+		MaxDepth = depth;
+
+	const StackEffect* effect = native ? native->GetStackEffect() : nullptr;
+	if (HasStaticEffect && effect)
+		Effect = Effect.Then(*effect);
+	else
+		HasStaticEffect = false;
+}
+
+const InterpretedDefinition* InterpretedDefinition::GetInlinable(const EmmentalDefinition* definition, std::size_t stepCount)
+{
+	const InterpretedDefinition* interpreted = definition ? definition->AsInterpreted() : nullptr;
+
+	if (!interpreted || interpreted->Steps.size() > MaxInlinedSize || interpreted->MaxDepth + 1 > MaxInlineDepth)
+		return nullptr;
+
+	if (stepCount + interpreted->Steps.size() > MaxInlinedTotal)
+		return nullptr;
+
+	return interpreted;
+}
+
+InterpretedDefinition::Size InterpretedDefinition::Measure(const ProgramT& program, const DefinitionTable& state)
+{
+	Size size = { 0, 0, 1 };
+
+	for (SymbolT symbol : program)
+	{
+		size.ProgramCellBytes = std::max(size.ProgramCellBytes, SymbolCells::GetCellBytes(symbol));
+
+		EmmentalDefinition* definition = state.Get(symbol);
+		const InterpretedDefinition* inlined = GetInlinable(definition, size.Steps);
+
+		if (inlined)
+		{
+			size.Steps += inlined->Steps.size();
+			size.Evals += inlined->EvalCaches.size();
+		}
+		else
+		{
+			size.Steps++;
+			if (IsEval(definition))
+				size.Evals++;
+		}
+	}
+
+	return size;
+}
+
+void InterpretedDefinition::Execute(Emmental* interpreter, std::size_t recursionLevel)
+{
+	// Every call of an interpreted definition is a cancellation point. Natives don't loop, so this bounds the symbols executed after a cancellation.
+	interpreter->CheckCancellation();
+
+	// Definitions with a static effect only execute natives, so they can't call themselves
+	CycleGuard cycles(HasStaticEffect ? nullptr : interpreter->GetCycleDetector());
+	if (!cycles.Enter(this))
+		interpreter->ReportCycle();
+
+	// Inlined steps run at the recursion level they would have been called at.
+	// Near the recursion limit, the program is executed without inlining, so the limit is reported at the same symbol.
+	// Statistics count the calls of inlined definitions too, so they're collected the same way.
+	if (recursionLevel + MaxDepth >= EMMENTAL_MAX_RECURSION_LEVEL || interpreter->GetStats())
+	{
+		interpreter->CountSteps(GetProgramSize());
+
+		for (std::size_t i = 0; i < GetProgramSize(); i++)
+		{
+			SymbolT symbol = GetProgramSymbol(i);
+			interpreter->Execute(GetCapture(symbol), symbol, recursionLevel);
+		}
+
+		return;
+	}
+
+	interpreter->CountSteps(Steps.size());
+
+	// With a static effect, the bounds of the whole program can be checked once at entry.
+	// Otherwise, or if that check fails, execute normally so errors are reported at the symbol that causes them.
+	if (HasStaticEffect && interpreter->CanExecuteUnchecked(Effect))
+	{
+		for (Step& step : Steps)
+			static_cast<NativeDefinition*>(step.Definition)->ExecuteUnchecked(interpreter, recursionLevel);
+
+		return;
+	}
+
+	for (std::size_t i = 0; i < Steps.size(); i++)
+	{
+		Step& step = Steps[i];
+		std::size_t level = recursionLevel + Origins[i].Depth;
+
+		if (step.Cache)
+		{
+			// Same as the '?' native, but the evaluated symbol is looked up through the cache
+			SymbolT symbol = interpreter->PopSymbol();
+			interpreter->Execute(step.Cache->Lookup(interpreter, symbol), symbol, level + 1);
+		}
+		else
+		{
+			interpreter->Execute(step.Definition, Origins[i].Symbol, level);
+		}
+	}
+}
+
+void InterpretedDefinition::Freeze()
+{
+	// A step without a cache executes the '?' native itself
+	for (Step& step : Steps)
+		step.Cache = nullptr;
+}
+
+EmmentalDefinition* InterpretedDefinition::GetCapture(SymbolT symbol) const
+{
+	for (auto& capture : Captures)
+	{
+		if (capture.first == symbol)
+			return capture.second.get();
+	}
+
+	return nullptr;
+}
+
+EmmentalDefinition* InterpretedDefinition::EvalCache::Lookup(Emmental* interpreter, SymbolT symbol)
+{
+	std::uint64_t version = interpreter->GetDefinitionsVersion();
+
+	if (Version == version)
+	{
+		for (std::size_t i = 0; i < Count; i++)
+		{
+			if (Symbols[i] == symbol)
+				return Definitions[i];
+		}
+	}
+	else
+	{
+		Version = version;
+		Count = 0;
+		Next = 0;
+	}
+
+	EmmentalDefinition* definition = interpreter->BorrowDefinition(symbol);
+	std::size_t entry = Count < Size ? Count++ : Next++ % Size;
+
+	Symbols[entry] = symbol;
+	Definitions[entry] = definition;
+	return definition;
+}
+
+const StackEffect* InterpretedDefinition::GetStackEffect() const { return HasStaticEffect ? &Effect : nullptr; }
+
+std::uint64_t InterpretedDefinition::GetContentHash() const { return ContentHash; }
+
+ProgramT InterpretedDefinition::GetProgram() const
+{
+	ProgramT program(GetProgramSize());
+	for (std::size_t i = 0; i < program.size(); i++)
+		program[i] = GetProgramSymbol(i);
+
+	return program;
+}
+
+SymbolMapT InterpretedDefinition::GetDefinitions() const { return SymbolMapT(Captures.begin(), Captures.end()); }
+
+std::size_t InterpretedDefinition::GetProgramSize() const { return Program.size() / ProgramCellBytes; }
+
+SymbolT InterpretedDefinition::GetProgramSymbol(std::size_t index) const { return SymbolCells::Load(Program.begin(), ProgramCellBytes, index); }
+
+std::size_t InterpretedDefinition::GetStepCount() const { return Steps.size(); }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <memory>
+#include "Config.h"
+#include "Arena.h"
+#include "DefinitionTable.h"
+#include "SymbolCells.h"
+#include "EmmentalDefinition.h"
+
+class InterpretedDefinition :
+	public EmmentalDefinition
+{
+public:
+	// Creates a definition for a program, capturing the definitions of its symbols from state.
+	// Small interpreted definitions that are captured are inlined, as captures never change.
+	// All data of the definition is allocated from the allocator's arena generation, or stored inline for short programs.
+	InterpretedDefinition(const ProgramT& program, const DefinitionTable& state, const ArenaAllocator<char>& allocator);
+	void Execute(Emmental* interpreter, std::size_t recursionLevel) override;
+	const StackEffect* GetStackEffect() const override;
+	// Interpreted definitions are hashed by their program and the contents of their captures
+	std::uint64_t GetContentHash() const override;
+	const InterpretedDefinition* AsInterpreted() const override { return this; }
+	// Evaluations then look up the interpreter's definitions every time, instead of going through their inline caches
+	void Freeze() override;
+
+	ProgramT GetProgram() const;
+	SymbolMapT GetDefinitions() const;
+	// Access to the program without copying it, for code that executes it symbol by symbol
+	std::size_t GetProgramSize() const;
+	SymbolT GetProgramSymbol(std::size_t index) const;
+	// Gets the captured definition of a symbol, nullptr if undefined
+	EmmentalDefinition* GetCapture(SymbolT symbol) const;
+	// Gets the number of symbols executed by the definition, not counting the calls of inlined definitions
+	std::size_t GetStepCount() const;
+
+private:
+	// Polymorphic inline cache of a '?' in the program, from evaluated symbols to their current global definitions
+	struct EvalCache
+	{
+		static const std::size_t Size = 4;
+
+		// Definitions version the entries are valid for
+		std::uint64_t Version = 0;
+		std::size_t Count = 0;
+		// Entry replaced next when the cache is full
+		std::size_t Next = 0;
+		SymbolT Symbols[Size];
+		// Borrowed from the interpreter's current definitions, only valid while they are at Version
+		EmmentalDefinition* Definitions[Size];
+
+		EmmentalDefinition* Lookup(Emmental* interpreter, SymbolT symbol);
+	};
+
+	struct Step
+	{
+		// Borrowed from Captures, or from the captures of an inlined definition. nullptr if undefined
+		EmmentalDefinition* Definition;
+		// Set if this step is a '?'
+		EvalCache* Cache;
+	};
+
+	// Kept apart from the steps, as executing with a static effect doesn't need it
+	struct StepOrigin
+	{
+		SymbolT Symbol;
+		// Number of inlined calls the step is nested in
+		std::size_t Depth;
+	};
+
+	// Programs are stored in the narrowest cells that hold all of their symbols, bytes for every program of an 8-bit run
+	static const std::size_t InlineProgramBytes = 16;
+	static const std::size_t InlineCaptureCount = 8;
+	static const std::size_t InlineStepCount = 8;
+
+	// Inlining budget: steps of a single inlined definition, steps of the whole definition, and nesting of inlined calls
+	static const std::size_t MaxInlinedSize = 32;
+	static const std::size_t MaxInlinedTotal = 256;
+	static const std::size_t MaxInlineDepth = 8;
+
+	ArenaArray<unsigned char, InlineProgramBytes> Program;
+	std::size_t ProgramCellBytes;
+	ArenaArray<std::pair<SymbolT, std::shared_ptr<EmmentalDefinition>>, InlineCaptureCount> Captures;
+	ArenaArray<Step, InlineStepCount> Steps;
+	ArenaArray<StepOrigin, InlineStepCount> Origins;
+	ArenaArray<EvalCache, 1> EvalCaches;
+	std::size_t MaxDepth;
+
+	// Set when every executed step is a captured native with a static effect
+	bool HasStaticEffect;
+	StackEffect Effect;
+	std::uint64_t ContentHash;
+
+	void AddStep(EmmentalDefinition* definition, SymbolT symbol, std::size_t depth);
+
+	// Gets a definition as an interpreted definition if it fits the inlining budget, given the steps before it
+	static const InterpretedDefinition* GetInlinable(const EmmentalDefinition* definition, std::size_t stepCount);
+
+	// Capacities needed by a program, inlining included
+	struct Size
+	{
+		std::size_t Steps;
+		std::size_t Evals;
+		std::size_t ProgramCellBytes;
+	};
+
+	InterpretedDefinition(const ProgramT& program, const DefinitionTable& state, const ArenaAllocator<char>& allocator, const Size& size);
+	static Size Measure(const ProgramT& program, const DefinitionTable& state);
+};
@@ -0,0 +1,34 @@
+#include "NativeDefinition.h"
+#include "CycleDetector.h"
+
+NativeDefinition::NativeDefinition(SymbolT symbol, std::function<void(Emmental*, std::size_t)> function)
+{
+	Symbol = symbol;
+	Function = function;
+	HasStaticEffect = false;
+}
+
+NativeDefinition::NativeDefinition(SymbolT symbol, const StackEffect& effect, std::function<void(Emmental*, std::size_t)> function, std::function<void(Emmental*, std::size_t)> uncheckedFunction)
+{
+	Symbol = symbol;
+	Function = function;
+	UncheckedFunction = uncheckedFunction;
+	HasStaticEffect = true;
+	Effect = effect;
+}
+
+void NativeDefinition::Execute(Emmental* interpreter, std::size_t recursionLevel)
+{
+	Function(interpreter, recursionLevel);
+}
+
+std::uint64_t NativeDefinition::GetContentHash() const { return CycleDetector::Mix(0, Symbol); }
+
+const StackEffect* NativeDefinition::GetStackEffect() const { return HasStaticEffect ? &Effect : nullptr; }
+
+void NativeDefinition::ExecuteUnchecked(Emmental* interpreter, std::size_t recursionLevel) const
+{
+	UncheckedFunction(interpreter, recursionLevel);
+}
+
+SymbolT NativeDefinition::GetSymbol() const { return Symbol; }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include <functional>
+#include "Config.h"
+#include "EmmentalDefinition.h"
+
+
+class NativeDefinition :
+	public EmmentalDefinition
+{
+public:	
+	// Creates a native whose effect depends on the interpreter state
+	NativeDefinition(SymbolT symbol, std::function<void(Emmental*, std::size_t)> function);
+	// Creates a native with a static stack effect, and a variant of it that skips bounds checks
+	NativeDefinition(SymbolT symbol, const StackEffect& effect, std::function<void(Emmental*, std::size_t)> function, std::function<void(Emmental*, std::size_t)> uncheckedFunction);
+	virtual void Execute(Emmental* interpreter, std::size_t recursionLevel) override;
+	virtual const StackEffect* GetStackEffect() const override;
+	virtual const NativeDefinition* AsNative() const override { return this; }
+	// Natives are hashed by their original symbol
+	virtual std::uint64_t GetContentHash() const override;
+
+	// Executes without bounds checks. Only valid for natives with a static stack effect, after the caller checked it.
+	void ExecuteUnchecked(Emmental* interpreter, std::size_t recursionLevel) const;
+
+	// Gets the symbol this native is originally defined as
+	SymbolT GetSymbol() const;
+
+private:
+	SymbolT Symbol;
+	std::function<void(Emmental*, std::size_t)> Function;
+	std::function<void(Emmental*, std::size_t)> UncheckedFunction;
+	bool HasStaticEffect;
+	StackEffect Effect;
+};
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "ProgramImage.h"
+#include <algorithm>
+#include <sstream>
+#include "DefinitionGraph.h"
+#include "TopLevel.h"
+
+ProgramImage::ProgramImage(std::vector<char> program, bool interpretPrefix) : Program(std::move(program)), Offset(0)
+{
+	// The prefix has no observable effects, so it never touches the streams
+	std::stringstream streams;
+	Emmental interpreter(streams, streams, streams);
+
+	if (interpretPrefix)
+		Offset = TopLevel::InterpretPrefix(interpreter, Program.data(), Program.size());
+
+	Definitions = interpreter.CopyDefinitions();
+	for (auto& definition : DefinitionGraph::Collect(Definitions))
+		definition->Freeze();
+
+	for (auto stack = interpreter.GetStack(); !stack.empty(); stack.pop())
+		Stack.push_back(stack.top());
+	std::reverse(Stack.begin(), Stack.end());
+
+	for (auto queue = interpreter.GetQueue(); !queue.empty(); queue.pop())
+		Queue.push_back(queue.front());
+}
+
+void ProgramImage::Restore(Emmental& interpreter) const
+{
+	interpreter.Reset();
+
+	for (SymbolT symbol : Stack)
+		interpreter.Push(symbol);
+	for (SymbolT symbol : Queue)
+		interpreter.Enqueue(symbol);
+	interpreter.SetDefinitions(Definitions);
+}
+
+const char* ProgramImage::GetRest() const { return Program.data() + Offset; }
+
+std::size_t ProgramImage::GetRestSize() const { return Program.size() - Offset; }
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Config.h"
+#include "Emmental.h"
+
+// A program prepared once to be run any number of times, from any number of threads at once.
+// Holds the program and the interpreter state after its input-independent prefix. The definitions of that state are frozen and shared by
+// every interpreter restored from the image, which copies only the symbol map pointing to them; redefining a symbol replaces its entry in that copy.
+class ProgramImage
+{
+public:
+	// Prepares a program. Unless interpretPrefix is false, its input-independent prefix is interpreted now instead of on every run.
+	ProgramImage(std::vector<char> program, bool interpretPrefix);
+
+	// Gives an interpreter the prepared state, after which it can interpret the rest of the program
+	void Restore(Emmental& interpreter) const;
+	const char* GetRest() const;
+	std::size_t GetRestSize() const;
+
+private:
+	std::vector<char> Program;
+	std::size_t Offset;
+	SymbolMapT Definitions;
+	// From bottom to top
+	std::vector<SymbolT> Stack;
+	std::vector<SymbolT> Queue;
+};
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "Quota.h"
+#include <chrono>
+#include "TopLevel.h"
+#include "EmmentalException.h"
+#include "Globals.h"
+#include "Util.h"
+
+// Steps executed between checks of the time and memory quotas. A step is cheap, so this keeps the time quota accurate to a few milliseconds.
+static const std::uint64_t SliceSteps = 16 * 1024;
+
+// Thrown by the meter of a limited run to stop it
+class QuotaExceededException : public EmmentalException
+{
+public:
+	QuotaExceededException(const char* quota) : EmmentalException("Quota exceeded."), Quota(quota) {}
+
+	// Name of the exceeded quota
+	const char* const Quota;
+};
+
+class QuotaMeter : public StepMeter
+{
+public:
+	std::uint64_t GetMilliseconds() const
+	{
+		return (std::uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	std::uint64_t Check(const Emmental& interpreter, std::uint64_t steps) override
+	{
+		if (Globals::MaxSteps != 0 && steps > Globals::MaxSteps)
+			throw QuotaExceededException("Step");
+		if (Globals::MaxMilliseconds != 0 && GetMilliseconds() >= Globals::MaxMilliseconds)
+			throw QuotaExceededException("Time");
+		if (Globals::MaxDefinitionBytes != 0 && interpreter.GetDefinitionBytes() > Globals::MaxDefinitionBytes)
+			throw QuotaExceededException("Memory");
+
+		// The step quota is checked again as soon as it would be exceeded
+		std::uint64_t next = steps + SliceSteps;
+		if (Globals::MaxSteps != 0 && next > Globals::MaxSteps)
+			next = Globals::MaxSteps + 1;
+
+		return next;
+	}
+
+private:
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+};
+
+bool Quota::IsLimited()
+{
+	return Globals::MaxSteps != 0 || Globals::MaxMilliseconds != 0 || Globals::MaxDefinitionBytes != 0;
+}
+
+bool Quota::Interpret(Emmental& interpreter, const char* program, std::size_t size)
+{
+	QuotaMeter meter;
+	const char* exceeded = nullptr;
+	interpreter.SetStepMeter(&meter);
+
+	try
+	{
+		TopLevel::Interpret(interpreter, program, size);
+	}
+	catch (const QuotaExceededException& exception)
+	{
+		exceeded = exception.Quota;
+	}
+	catch (...)
+	{
+		interpreter.SetStepMeter(nullptr);
+		throw;
+	}
+
+	std::uint64_t steps = interpreter.GetStepCount();
+	interpreter.SetStepMeter(nullptr);
+
+	if (!exceeded)
+		return true;
+
+	if (!interpreter.GetOptions().QuietMode)
+	{
+		std::ostream& error = interpreter.ErrorStream;
+
+		Util::Colorize(Util::ConsoleColor::BrightRed, error);
+		error << "Error: ";
+		Util::Colorize(Util::ConsoleColor::Default, error);
+		error << exceeded << " quota exceeded. Executed " << steps << " steps in " << meter.GetMilliseconds() << " ms, definitions hold "
+			<< interpreter.GetDefinitionBytes() << " bytes." << std::endl;
+	}
+
+	return false;
+}
\ No newline at end of file
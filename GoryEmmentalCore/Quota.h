@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include "Emmental.h"
+
+// Limits on the steps, wall-clock time and definition memory of a run, selected in Globals.
+// A limited run is interpreted as usual, counting its steps at definition boundaries, and the quotas are checked every slice of steps.
+namespace Quota
+{
+	// Exit status of a run stopped by a quota
+	const int ExitCode = 3;
+
+	// Checks if any quota is selected
+	bool IsLimited();
+	// Interprets a program within the quotas, like TopLevel::Interpret(). Returns false, and prints a summary unless quiet, if a quota was exceeded.
+	bool Interpret(Emmental& interpreter, const char* program, std::size_t size);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "ScratchFile.h"
+#include <algorithm>
+
+#if !_WIN32
+#	include <cstdlib>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#endif
+
+#if !_WIN32
+std::unique_ptr<ScratchFile> ScratchFile::Create(const std::string& directory, std::size_t blockSize)
+{
+	std::string path = directory;
+	if (!path.empty() && path.back() != '/')
+		path += '/';
+	path += "GoryEmmental-XXXXXX";
+
+	int descriptor = mkstemp(&path[0]);
+	if (descriptor < 0)
+		return nullptr;
+
+	unlink(path.c_str());
+	return std::unique_ptr<ScratchFile>(new ScratchFile(descriptor, blockSize));
+}
+
+ScratchFile::ScratchFile(int descriptor, std::size_t blockSize) : Descriptor(descriptor), BlockSize(blockSize)
+{
+}
+
+ScratchFile::~ScratchFile()
+{
+	for (char* chunk : Chunks)
+		munmap(chunk, BlockSize * BlocksPerChunk);
+
+	close(Descriptor);
+}
+
+void* ScratchFile::Allocate()
+{
+	if (FreeBlocks.empty())
+	{
+		std::size_t chunkSize = BlockSize * BlocksPerChunk;
+		if (ftruncate(Descriptor, (off_t)(FileSize + chunkSize)) != 0)
+			return nullptr;
+
+		void* chunk = mmap(nullptr, chunkSize, PROT_READ | PROT_WRITE, MAP_SHARED, Descriptor, (off_t)FileSize);
+		if (chunk == MAP_FAILED)
+			return nullptr;
+
+		FileSize += chunkSize;
+		Chunks.push_back(static_cast<char*>(chunk));
+
+		// Handed out from the start of the chunk, so the file is used in order
+		for (std::size_t i = BlocksPerChunk; i > 0; i--)
+			FreeBlocks.push_back(static_cast<char*>(chunk) + (i - 1) * BlockSize);
+	}
+
+	void* block = FreeBlocks.back();
+	FreeBlocks.pop_back();
+	return block;
+}
+
+void ScratchFile::Release(void* block)
+{
+	// The contents are dropped instead of written back, freeing their space in the file
+#ifdef MADV_REMOVE
+	madvise(block, BlockSize, MADV_REMOVE);
+#endif
+	FreeBlocks.push_back(block);
+}
+
+bool ScratchFile::Owns(const void* block) const
+{
+	const char* address = static_cast<const char*>(block);
+	return std::any_of(Chunks.begin(), Chunks.end(), [&](const char* chunk) { return address >= chunk && address < chunk + BlockSize * BlocksPerChunk; });
+}
+
+void ScratchFile::Evict(void* block)
+{
+#if defined(MADV_PAGEOUT)
+	madvise(block, BlockSize, MADV_PAGEOUT);
+#elif defined(MADV_COLD)
+	madvise(block, BlockSize, MADV_COLD);
+#else
+	msync(block, BlockSize, MS_ASYNC);
+#endif
+}
+
+void ScratchFile::Prefetch(void* block)
+{
+	madvise(block, BlockSize, MADV_WILLNEED);
+}
+#else // !_WIN32
+std::unique_ptr<ScratchFile> ScratchFile::Create(const std::string&, std::size_t) { return nullptr; }
+ScratchFile::ScratchFile(int descriptor, std::size_t blockSize) : Descriptor(descriptor), BlockSize(blockSize) {}
+ScratchFile::~ScratchFile() {}
+void* ScratchFile::Allocate() { return nullptr; }
+void ScratchFile::Release(void*) {}
+bool ScratchFile::Owns(const void*) const { return false; }
+void ScratchFile::Evict(void*) {}
+void ScratchFile::Prefetch(void*) {}
+#endif // !_WIN32
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Fixed-size blocks of memory backed by a temporary file mapped in memory, instead of by RAM or swap.
+// Blocks that won't be used for a while can be handed to the file, and read back ahead of their next use.
+// The file is deleted as soon as it's created, so it disappears with the process. Only available on POSIX systems.
+class ScratchFile
+{
+public:
+	// Creates a scratch file in a directory. Returns nullptr if it can't be created.
+	static std::unique_ptr<ScratchFile> Create(const std::string& directory, std::size_t blockSize);
+	~ScratchFile();
+
+	ScratchFile(const ScratchFile&) = delete;
+	ScratchFile& operator=(const ScratchFile&) = delete;
+
+	// Gets a block, growing the file if needed. Returns nullptr if the file can't grow.
+	void* Allocate();
+	// Gives a block back, discarding its contents
+	void Release(void* block);
+	// Checks if a block was allocated from this file
+	bool Owns(const void* block) const;
+
+	// Writes a block to the file and frees its memory, it's read back when next used
+	void Evict(void* block);
+	// Starts reading a block from the file, so it's in memory by the time it's used
+	void Prefetch(void* block);
+
+private:
+	ScratchFile(int descriptor, std::size_t blockSize);
+
+	// Blocks mapped at once when the file grows
+	static const std::size_t BlocksPerChunk = 64;
+
+	int Descriptor;
+	std::size_t BlockSize;
+	std::size_t FileSize = 0;
+	std::vector<char*> Chunks;
+	std::vector<void*> FreeBlocks;
+};
\ No newline at end of file
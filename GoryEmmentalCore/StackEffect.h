@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <algorithm>
+
+// Static effect of executing a definition on the stack and queue sizes
+struct StackEffect
+{
+	// Number of items that must be present before executing
+	std::ptrdiff_t StackRequired = 0;
+	// Highest number of items above the initial size at any point during execution
+	std::ptrdiff_t StackGrowth = 0;
+	// Change in the number of items after executing
+	std::ptrdiff_t StackDelta = 0;
+
+	std::ptrdiff_t QueueRequired = 0;
+	std::ptrdiff_t QueueGrowth = 0;
+	std::ptrdiff_t QueueDelta = 0;
+
+	// Effect of a native that pops and dequeues all of its inputs before pushing and enqueuing its outputs
+	static StackEffect Native(std::ptrdiff_t pops, std::ptrdiff_t pushes, std::ptrdiff_t dequeues = 0, std::ptrdiff_t enqueues = 0)
+	{
+		StackEffect effect;
+		effect.StackRequired = pops;
+		effect.StackDelta = pushes - pops;
+		effect.StackGrowth = std::max<std::ptrdiff_t>(0, effect.StackDelta);
+		effect.QueueRequired = dequeues;
+		effect.QueueDelta = enqueues - dequeues;
+		effect.QueueGrowth = std::max<std::ptrdiff_t>(0, effect.QueueDelta);
+		return effect;
+	}
+
+	// Effect of executing this, followed by next
+	StackEffect Then(const StackEffect& next) const
+	{
+		StackEffect effect;
+		effect.StackRequired = std::max(StackRequired, next.StackRequired - StackDelta);
+		effect.StackGrowth = std::max(StackGrowth, StackDelta + next.StackGrowth);
+		effect.StackDelta = StackDelta + next.StackDelta;
+		effect.QueueRequired = std::max(QueueRequired, next.QueueRequired - QueueDelta);
+		effect.QueueGrowth = std::max(QueueGrowth, QueueDelta + next.QueueGrowth);
+		effect.QueueDelta = QueueDelta + next.QueueDelta;
+		return effect;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "StateCache.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <unordered_map>
+#include "NativeDefinition.h"
+#include "InterpretedDefinition.h"
+#include "DefinitionGraph.h"
+#include "Globals.h"
+#include "BinaryIo.h"
+#include "FileReplacement.h"
+
+// Bump whenever the file layout or the interpreter semantics change, to invalidate old caches
+static const std::uint32_t CacheVersion = 2;
+static const char CacheMagic[4] = { 'G', 'E', 'M', 'C' };
+
+enum class NodeKind : std::uint8_t { Native = 0, Interpreted = 1 };
+
+using BinaryIo::Write;
+using BinaryIo::Read;
+using BinaryIo::Fits;
+
+static void WriteMap(std::ostream& output, const SymbolMapT& map, std::unordered_map<const EmmentalDefinition*, std::uint32_t>& indexes)
+{
+	Write<std::uint32_t>(output, (std::uint32_t)map.size());
+	for (auto& pair : map)
+	{
+		Write<SymbolT>(output, pair.first);
+		Write<std::uint32_t>(output, indexes.at(pair.second.get()));
+	}
+}
+
+static bool ReadMap(std::istream& input, SymbolMapT& map, const std::vector<std::shared_ptr<EmmentalDefinition>>& nodes)
+{
+	std::uint32_t count;
+	if (!Read(input, count))
+		return false;
+
+	for (std::uint32_t i = 0; i < count; i++)
+	{
+		SymbolT symbol;
+		std::uint32_t index;
+
+		if (!Read(input, symbol) || !Read(input, index) || index >= nodes.size())
+			return false;
+
+		map[symbol] = nodes[index];
+	}
+
+	return true;
+}
+
+std::uint64_t StateCache::GetKey(const std::vector<char>& program)
+{
+	// 64-bit FNV-1a
+	std::uint64_t hash = 14695981039346656037ULL;
+	auto combine = [&hash](unsigned char byte)
+	{
+		hash ^= byte;
+		hash *= 1099511628211ULL;
+	};
+
+	for (char x : program)
+		combine((unsigned char)x);
+
+	// Options that change which prefix is effect-free or what it computes
+	combine(Globals::OptimizeProgram);
+	combine(Globals::IgnoreWhitespace);
+	combine(Globals::QuietMode);
+	combine(Globals::LenientMode);
+	combine((unsigned char)Globals::CellWidth);
+
+	for (std::size_t i = 0; i < sizeof(std::uint64_t); i++)
+	{
+		combine((unsigned char)((std::uint64_t)Globals::MaxStackSize >> (i * 8)));
+		combine((unsigned char)((std::uint64_t)Globals::MaxQueueSize >> (i * 8)));
+	}
+
+	combine(Globals::DetectCycles);
+
+	for (std::size_t i = 0; i < sizeof(CacheVersion); i++)
+		combine((unsigned char)(CacheVersion >> (i * 8)));
+
+	return hash;
+}
+
+std::string StateCache::GetPath(const std::string& directory, std::uint64_t key)
+{
+	std::ostringstream path;
+	path << directory;
+
+	if (!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+		path << '/';
+
+	path << std::hex << std::setfill('0') << std::setw(16) << key << ".emc";
+	return path.str();
+}
+
+bool StateCache::Load(const std::string& path, std::uint64_t key, Emmental& interpreter, std::size_t& offset)
+{
+	std::ifstream file(path, std::ios_base::binary | std::ios_base::in);
+	if (!file)
+		return false;
+
+	// Counts are checked against the size of the file before anything is allocated for them, so a damaged cache is only a miss
+	if (!file.seekg(0, std::ios_base::end))
+		return false;
+	std::streamoff end = file.tellg();
+	if (end < 0 || !file.seekg(0, std::ios_base::beg))
+		return false;
+	std::uint64_t size = (std::uint64_t)end;
+
+	char magic[sizeof(CacheMagic)];
+	std::uint32_t version;
+	std::uint64_t storedKey;
+	std::uint64_t storedOffset;
+
+	if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), CacheMagic))
+		return false;
+	if (!Read(file, version) || version != CacheVersion)
+		return false;
+	if (!Read(file, storedKey) || storedKey != key)
+		return false;
+	if (!Read(file, storedOffset))
+		return false;
+
+	std::uint32_t count;
+	std::vector<SymbolT> stack;
+	std::vector<SymbolT> queue;
+
+	if (!Read(file, count) || count > Globals::MaxStackSize || !Fits(file, size, count, sizeof(SymbolT)))
+		return false;
+	stack.resize(count);
+	for (auto& symbol : stack)
+		if (!Read(file, symbol)) return false;
+
+	if (!Read(file, count) || count > Globals::MaxQueueSize || !Fits(file, size, count, sizeof(SymbolT)))
+		return false;
+	queue.resize(count);
+	for (auto& symbol : queue)
+		if (!Read(file, symbol)) return false;
+
+	// Natives are stored by their original symbol, and are taken from the interpreter's default definitions
+	interpreter.Reset();
+	SymbolMapT defaults = interpreter.CopyDefinitions();
+	std::vector<std::shared_ptr<EmmentalDefinition>> nodes;
+
+	if (!Read(file, count))
+		return false;
+
+	for (std::uint32_t i = 0; i < count; i++)
+	{
+		std::uint8_t kind;
+		if (!Read(file, kind))
+			return false;
+
+		if (kind == (std::uint8_t)NodeKind::Native)
+		{
+			SymbolT symbol;
+			if (!Read(file, symbol) || defaults.find(symbol) == defaults.end())
+				return false;
+
+			nodes.push_back(defaults[symbol]);
+		}
+		else if (kind == (std::uint8_t)NodeKind::Interpreted)
+		{
+			std::uint32_t length;
+			if (!Read(file, length) || !Fits(file, size, length, sizeof(SymbolT)))
+				return false;
+
+			ProgramT program(length);
+			for (auto& symbol : program)
+				if (!Read(file, symbol)) return false;
+
+			SymbolMapT captured;
+			if (!ReadMap(file, captured, nodes))
+				return false;
+
+			nodes.push_back(interpreter.CreateDefinition(program, captured));
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	SymbolMapT definitions;
+	if (!ReadMap(file, definitions, nodes))
+		return false;
+
+	for (SymbolT symbol : stack)
+		interpreter.Push(symbol);
+	for (SymbolT symbol : queue)
+		interpreter.Enqueue(symbol);
+	interpreter.SetDefinitions(definitions);
+
+	offset = (std::size_t)storedOffset;
+	return true;
+}
+
+// Writes the state of an interpreter to a cache file
+static bool WriteCache(const std::string& path, std::uint64_t key, const Emmental& interpreter, std::size_t offset)
+{
+	std::ofstream file(path, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+	if (!file)
+		return false;
+
+	file.write(CacheMagic, sizeof(CacheMagic));
+	Write(file, CacheVersion);
+	Write(file, key);
+	Write<std::uint64_t>(file, offset);
+
+	std::vector<SymbolT> stack;
+	for (auto copy = interpreter.GetStack(); !copy.empty(); copy.pop())
+		stack.push_back(copy.top());
+	std::reverse(stack.begin(), stack.end());
+
+	Write<std::uint32_t>(file, (std::uint32_t)stack.size());
+	for (SymbolT symbol : stack)
+		Write(file, symbol);
+
+	auto queue = interpreter.GetQueue();
+	Write<std::uint32_t>(file, (std::uint32_t)queue.size());
+	for (; !queue.empty(); queue.pop())
+		Write(file, queue.front());
+
+	SymbolMapT definitions = interpreter.CopyDefinitions();
+	// Captures come before the definitions capturing them, so that loading can rebuild them in order
+	std::vector<std::shared_ptr<EmmentalDefinition>> nodes = DefinitionGraph::Collect(definitions);
+	std::unordered_map<const EmmentalDefinition*, std::uint32_t> indexes;
+
+	for (std::uint32_t i = 0; i < nodes.size(); i++)
+		indexes[nodes[i].get()] = i;
+
+	Write<std::uint32_t>(file, (std::uint32_t)nodes.size());
+	for (auto& node : nodes)
+	{
+		const InterpretedDefinition* interpreted = dynamic_cast<const InterpretedDefinition*>(node.get());
+		if (interpreted)
+		{
+			ProgramT program = interpreted->GetProgram();
+
+			Write(file, (std::uint8_t)NodeKind::Interpreted);
+			Write<std::uint32_t>(file, (std::uint32_t)program.size());
+			for (SymbolT symbol : program)
+				Write(file, symbol);
+
+			WriteMap(file, interpreted->GetDefinitions(), indexes);
+		}
+		else
+		{
+			Write(file, (std::uint8_t)NodeKind::Native);
+			Write(file, static_cast<const NativeDefinition*>(node.get())->GetSymbol());
+		}
+	}
+
+	WriteMap(file, definitions, indexes);
+
+	// Closing flushes what is left, which can fail too
+	file.close();
+	return !file.fail();
+}
+
+bool StateCache::Save(const std::string& path, std::uint64_t key, const Emmental& interpreter, std::size_t offset)
+{
+	// Sizes are stored in 32 bits
+	if (interpreter.GetStackSize() > UINT32_MAX || interpreter.GetQueueSize() > UINT32_MAX)
+		return false;
+
+	// Write to a temporary file of this run first, so concurrent runs never see a partial cache nor write over each other
+	std::string temporaryPath = FileReplacement::CreateTemporary(path);
+	if (temporaryPath.empty())
+		return false;
+
+	if (!WriteCache(temporaryPath, key, interpreter, offset) || !FileReplacement::Replace(temporaryPath, path))
+	{
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Emmental.h"
+
+// Stores interpreter states on disk so that the input-independent prefix of a program only needs to be executed once.
+namespace StateCache
+{
+	// Computes the cache key of a program, which also covers every runtime option that can change its execution.
+	std::uint64_t GetKey(const std::vector<char>& program);
+	// Gets the path of the cache file for a key inside a cache directory.
+	std::string GetPath(const std::string& directory, std::uint64_t key);
+
+	// Restores a cached state into an interpreter and outputs the program offset to resume from. Returns false if no valid cache was found.
+	bool Load(const std::string& path, std::uint64_t key, Emmental& interpreter, std::size_t& offset);
+	// Saves the state of an interpreter, to be resumed at the selected program offset. Returns false if the cache couldn't be written.
+	bool Save(const std::string& path, std::uint64_t key, const Emmental& interpreter, std::size_t offset);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Config.h"
+
+// Symbols stored in cells of 1, 2, 4 or 8 bytes, so memory holding narrow symbols takes no more than they need
+namespace SymbolCells
+{
+	// Cells are copied byte by byte, which compilers turn into a single load or store
+	template<typename CellT>
+	SymbolT LoadCell(const unsigned char* cells, std::size_t position)
+	{
+		CellT cell;
+		std::memcpy(&cell, cells + position * sizeof(CellT), sizeof(CellT));
+		return cell;
+	}
+
+	template<typename CellT>
+	void StoreCell(unsigned char* cells, std::size_t position, SymbolT symbol)
+	{
+		CellT cell = (CellT)symbol;
+		std::memcpy(cells + position * sizeof(CellT), &cell, sizeof(CellT));
+	}
+
+	inline SymbolT Load(const unsigned char* cells, std::size_t cellBytes, std::size_t position)
+	{
+		switch (cellBytes)
+		{
+		case 1: return cells[position];
+		case 2: return LoadCell<std::uint16_t>(cells, position);
+		case 4: return LoadCell<std::uint32_t>(cells, position);
+		default: return LoadCell<std::uint64_t>(cells, position);
+		}
+	}
+
+	// Symbols wider than a cell are truncated
+	inline void Store(unsigned char* cells, std::size_t cellBytes, std::size_t position, SymbolT symbol)
+	{
+		switch (cellBytes)
+		{
+		case 1: cells[position] = (unsigned char)symbol; break;
+		case 2: StoreCell<std::uint16_t>(cells, position, symbol); break;
+		case 4: StoreCell<std::uint32_t>(cells, position, symbol); break;
+		default: StoreCell<std::uint64_t>(cells, position, symbol); break;
+		}
+	}
+
+	// Gets the size of the narrowest cell that holds a symbol
+	inline std::size_t GetCellBytes(SymbolT symbol)
+	{
+		return symbol <= UINT8_MAX ? 1 : symbol <= UINT16_MAX ? 2 : symbol <= UINT32_MAX ? 4 : 8;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "SymbolDeque.h"
+
+SymbolDeque::SymbolDeque(const std::string& spillDirectory, unsigned int cellWidth)
+	: CellBytes(cellWidth / 8), SegmentSize(SegmentBytes / (cellWidth / 8)), SegmentShift(0), SpillDirectory(spillDirectory)
+{
+	while (((std::size_t)1 << SegmentShift) < SegmentSize)
+		SegmentShift++;
+
+	Segments.push_back(AllocateSegment(false));
+	Serials.push_back(NextSerial++);
+	UpdateEnds();
+}
+
+SymbolDeque::~SymbolDeque()
+{
+	for (unsigned char* segment : Segments)
+		FreeSegment(segment);
+
+	if (Spare)
+		FreeSegment(Spare);
+}
+
+SymbolT SymbolDeque::At(std::size_t index) const
+{
+	std::size_t position = Head + index;
+	return Load(Segments[position >> SegmentShift], position & (SegmentSize - 1));
+}
+
+void SymbolDeque::Clear()
+{
+	while (Segments.size() > 1)
+	{
+		ReleaseSegment(Segments.back());
+		Segments.pop_back();
+		Serials.pop_back();
+	}
+
+	// The remaining segment is reused as the back one
+	Serials.back() = NextSerial++;
+	UpdateEnds();
+	Head = 0;
+	Tail = 0;
+	Count = 0;
+}
+
+void SymbolDeque::AddBackSegment()
+{
+	// Small sequences stay in memory, only segments allocated once both hot windows are full can be spilled
+	Segments.push_back(AllocateSegment(Segments.size() >= 2 * HotSegments));
+	Serials.push_back(NextSerial++);
+	UpdateEnds();
+	Tail = 0;
+
+	// The segment that just left the back window won't be used until the back shrinks to it, or the front reaches it
+	if (Scratch && Segments.size() > 2 * HotSegments)
+	{
+		std::size_t leaving = Segments.size() - 1 - HotSegments;
+		if (Scratch->Owns(Segments[leaving]))
+			Scratch->Evict(Segments[leaving]);
+	}
+}
+
+void SymbolDeque::RemoveBackSegment()
+{
+	// The last segment is kept to push into
+	if (Segments.size() == 1)
+		return;
+
+	ReleaseSegment(Segments.back());
+	Segments.pop_back();
+	Serials.pop_back();
+	Serials.back() = NextSerial++;
+	UpdateEnds();
+	Tail = SegmentSize;
+
+	// Popping reads segments in order, so the segment that just entered the back window is read ahead
+	if (Scratch && Segments.size() > HotSegments && Scratch->Owns(Segments[Segments.size() - HotSegments]))
+		Scratch->Prefetch(Segments[Segments.size() - HotSegments]);
+}
+
+void SymbolDeque::RemoveFrontSegment()
+{
+	if (Segments.size() == 1)
+	{
+		// Empty, start over at the beginning of the segment
+		Head = 0;
+		Tail = 0;
+		return;
+	}
+
+	ReleaseSegment(Segments.front());
+	Segments.pop_front();
+	Serials.pop_front();
+	UpdateEnds();
+	Head = 0;
+
+	// Dequeuing reads segments in order, so the segment that just entered the front window is read ahead
+	if (Scratch && Segments.size() > HotSegments && Scratch->Owns(Segments[HotSegments - 1]))
+		Scratch->Prefetch(Segments[HotSegments - 1]);
+}
+
+unsigned char* SymbolDeque::AllocateSegment(bool cold)
+{
+	if (Spare)
+	{
+		unsigned char* segment = Spare;
+		Spare = nullptr;
+		return segment;
+	}
+
+	if (cold && !SpillDirectory.empty())
+	{
+		if (!Scratch)
+		{
+			Scratch = ScratchFile::Create(SpillDirectory, SegmentBytes);
+
+			// Without a scratch file, everything stays in memory
+			if (!Scratch)
+				SpillDirectory.clear();
+		}
+
+		void* segment = Scratch ? Scratch->Allocate() : nullptr;
+		if (segment)
+			return static_cast<unsigned char*>(segment);
+	}
+
+	return new unsigned char[SegmentBytes];
+}
+
+void SymbolDeque::ReleaseSegment(unsigned char* segment)
+{
+	if (Spare)
+		FreeSegment(Spare);
+
+	Spare = segment;
+}
+
+void SymbolDeque::FreeSegment(unsigned char* segment)
+{
+	if (Scratch && Scratch->Owns(segment))
+		Scratch->Release(segment);
+	else
+		delete[] segment;
+}
+
+void SymbolDeque::UpdateEnds()
+{
+	FrontSegment = Segments.front();
+	BackSegment = Segments.back();
+}
\ No newline at end of file
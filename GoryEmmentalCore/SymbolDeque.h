@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include "Config.h"
+#include "SymbolCells.h"
+#include "ScratchFile.h"
+
+// Sequence of symbols added at the back and removed from either end, used for the stack and the queue. Symbols are stored in fixed-size segments,
+// in cells of the interpreter's cell width, so 8-bit runs take a byte per symbol.
+// With a spill directory, segments past a hot window at each end are allocated from a scratch file and evicted from memory,
+// and read back one segment ahead as either end approaches them, so a sequence far larger than RAM is still accessed at near-RAM speed.
+class SymbolDeque
+{
+public:
+	// Size of a segment, 64 KiB to match the page size of every supported system
+	static const std::size_t SegmentBytes = 64 * 1024;
+	// Segments kept in memory at each end
+	static const std::size_t HotSegments = 4;
+
+	// Stores symbols in cells of cellWidth bits, which must be 8, 16, 32 or 64. Keeps every segment in memory if spillDirectory is empty.
+	SymbolDeque(const std::string& spillDirectory, unsigned int cellWidth);
+	~SymbolDeque();
+
+	SymbolDeque(const SymbolDeque&) = delete;
+	SymbolDeque& operator=(const SymbolDeque&) = delete;
+
+	std::size_t Size() const { return Count; }
+	bool Empty() const { return Count == 0; }
+	// Gets a symbol by position from the front
+	SymbolT At(std::size_t index) const;
+
+	SymbolT Front() const { return Load(FrontSegment, Head); }
+	SymbolT Back() const { return Load(BackSegment, Tail - 1); }
+
+	// Symbols wider than a cell are truncated
+	void PushBack(SymbolT item)
+	{
+		if (Tail == SegmentSize)
+			AddBackSegment();
+
+		SymbolCells::Store(BackSegment, CellBytes, Tail++, item);
+		Count++;
+	}
+
+	void PopBack()
+	{
+		Tail--;
+		Count--;
+
+		if (Tail == 0)
+			RemoveBackSegment();
+	}
+
+	void PopFront()
+	{
+		Head++;
+		Count--;
+
+		if (Head == SegmentSize || Count == 0)
+			RemoveFrontSegment();
+	}
+
+	void Clear();
+
+	// Segments in order from the front, for code that saves the sequence a segment at a time, and reads them back with Load().
+	// The front segment starts at GetHead(), every segment but the back one is full, and the back one ends at GetTail().
+	std::size_t GetSegmentCount() const { return Segments.size(); }
+	const unsigned char* GetSegment(std::size_t index) const { return Segments[index]; }
+	// Gets the number of symbols in a full segment, which depends on the cell width
+	std::size_t GetSegmentSize() const { return SegmentSize; }
+	std::size_t GetHead() const { return Head; }
+	std::size_t GetTail() const { return Tail; }
+	// Reads a symbol at a position of a segment of this sequence, or of one stored by a sequence of the same cell width
+	SymbolT Load(const unsigned char* segment, std::size_t position) const { return SymbolCells::Load(segment, CellBytes, position); }
+
+	// Gets a number that changes whenever the contents of a segment may change. A segment only changes while it's the back one,
+	// so a full segment keeps the contents it had when it last had this serial, even after segments are removed in front of it.
+	std::uint64_t GetSegmentSerial(std::size_t index) const { return Serials[index]; }
+
+private:
+	std::size_t CellBytes;
+	// Symbols in a segment, a power of two
+	std::size_t SegmentSize;
+	unsigned int SegmentShift;
+	std::string SpillDirectory;
+	// Created the first time the sequence outgrows its hot windows
+	std::unique_ptr<ScratchFile> Scratch;
+	std::deque<unsigned char*> Segments;
+	std::deque<std::uint64_t> Serials;
+	std::uint64_t NextSerial = 0;
+	// Last released segment, kept so an end moving back and forth over a segment boundary doesn't allocate every time
+	unsigned char* Spare = nullptr;
+
+	unsigned char* FrontSegment;
+	unsigned char* BackSegment;
+	// Position of the front symbol in the front segment, and past the back symbol in the back segment
+	std::size_t Head = 0;
+	std::size_t Tail = 0;
+	std::size_t Count = 0;
+
+	void AddBackSegment();
+	void RemoveBackSegment();
+	void RemoveFrontSegment();
+	unsigned char* AllocateSegment(bool cold);
+	void ReleaseSegment(unsigned char* segment);
+	void FreeSegment(unsigned char* segment);
+	void UpdateEnds();
+};
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include "Config.h"
+
+// Set of symbols. Byte symbols are stored in a 256-bit bitmap, wider symbols in a set.
+class SymbolSet
+{
+public:
+	// Adds a symbol, returning false if it was already in the set
+	bool Insert(SymbolT symbol)
+	{
+		if (symbol >= ByteCount)
+			return Wide.insert(symbol).second;
+
+		std::uint64_t& word = Bits[symbol / 64];
+		std::uint64_t bit = std::uint64_t(1) << (symbol % 64);
+
+		if (word & bit)
+			return false;
+
+		word |= bit;
+		return true;
+	}
+
+	bool Contains(SymbolT symbol) const
+	{
+		if (symbol >= ByteCount)
+			return Wide.count(symbol) != 0;
+
+		return (Bits[symbol / 64] >> (symbol % 64)) & 1;
+	}
+
+private:
+	static const SymbolT ByteCount = 256;
+
+	std::uint64_t Bits[ByteCount / 64] = {};
+	std::set<SymbolT> Wide;
+};
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "TopLevel.h"
+#include <cctype>
+#include <cstdint>
+#include "NativeDefinition.h"
+#include "EmmentalException.h"
+
+// Runs are split at this length, longer runs are less likely to fit the stack and queue bounds as a whole
+static const std::size_t MaxRunLength = 32;
+
+// Natives with a static effect that byte symbols are currently defined as.
+// Each entry is guarded by the definitions version it was resolved at, and resolved again once the definitions change.
+struct NativeCache
+{
+	std::uint64_t Versions[256] = {};
+	const NativeDefinition* Natives[256];
+
+	const NativeDefinition* Get(const Emmental& interpreter, std::uint64_t version, unsigned char symbol)
+	{
+		if (Versions[symbol] != version)
+		{
+			const EmmentalDefinition* definition = interpreter.BorrowDefinition(symbol);
+			const NativeDefinition* native = definition ? definition->AsNative() : nullptr;
+
+			Natives[symbol] = native && native->GetStackEffect() ? native : nullptr;
+			Versions[symbol] = version;
+		}
+
+		return Natives[symbol];
+	}
+};
+
+// Interprets a program like TopLevel::Interpret(), keeping in executed the position of the symbol being executed,
+// so it's known how far the program got if a symbol throws
+static void InterpretTracked(Emmental& interpreter, const char* program, std::size_t size, std::size_t& executed)
+{
+	NativeCache cache;
+	const NativeDefinition* run[MaxRunLength];
+	std::size_t positions[MaxRunLength];
+	std::size_t i = 0;
+
+	while (i < size)
+	{
+		StackEffect effect;
+		std::size_t start = i;
+		std::size_t length = 0;
+		// Natives with a static effect don't change the definitions, so the version holds for the whole run
+		std::uint64_t version = interpreter.GetDefinitionsVersion();
+
+		for (; i < size && length < MaxRunLength; i++)
+		{
+			unsigned char symbol = (unsigned char)program[i];
+
+			if (interpreter.GetOptions().IgnoreWhitespace && std::isspace(symbol))
+				continue;
+
+			const NativeDefinition* native = cache.Get(interpreter, version, symbol);
+			if (!native)
+				break;
+
+			effect = effect.Then(*native->GetStackEffect());
+			positions[length] = i;
+			run[length++] = native;
+		}
+
+		// Natives are never released, so borrowing them for the whole run is safe
+		if (length > 1 && interpreter.CanExecuteUnchecked(effect))
+		{
+			// Natives with a static effect may still have an observable one, like '.'
+			for (std::size_t j = 0; j < length; j++)
+			{
+				executed = positions[j];
+				interpreter.CountSteps(1);
+				run[j]->ExecuteUnchecked(&interpreter, 0);
+			}
+		}
+		else
+		{
+			for (std::size_t j = start; j < i; j++)
+			{
+				executed = j;
+
+				if (!(interpreter.GetOptions().IgnoreWhitespace && std::isspace((unsigned char)program[j])))
+				{
+					interpreter.CountSteps(1);
+					interpreter.Interpret((unsigned char)program[j]);
+				}
+			}
+		}
+
+		// A symbol without a static effect ended the run. It may change the definitions, so the rest is compiled after it ran.
+		if (i < size && length < MaxRunLength)
+		{
+			executed = i;
+			interpreter.CountSteps(1);
+			interpreter.Interpret((unsigned char)program[i++]);
+		}
+	}
+
+	executed = size;
+}
+
+void TopLevel::Interpret(Emmental& interpreter, const char* program, std::size_t size)
+{
+	std::size_t executed = 0;
+	InterpretTracked(interpreter, program, size, executed);
+}
+
+std::size_t TopLevel::InterpretPrefix(Emmental& interpreter, const char* program, std::size_t size)
+{
+	std::size_t end = 0;
+	interpreter.SetEffectBarrier(true);
+
+	try
+	{
+		// Symbols are interpreted as usual, with a single cache of natives, until one hits the barrier
+		InterpretTracked(interpreter, program, size, end);
+		interpreter.SetEffectBarrier(false);
+	}
+	catch (const EffectBarrierException&)
+	{
+		// The symbol that hit the barrier may have changed the state before trying its effect.
+		// The prefix is deterministic, so rebuild its state from scratch.
+		interpreter.SetEffectBarrier(false);
+		interpreter.Reset();
+		Interpret(interpreter, program, end);
+	}
+
+	return end;
+}
\ No newline at end of file
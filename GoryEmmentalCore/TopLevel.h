@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include "Emmental.h"
+
+// Executes top-level code. Runs of natives with a static effect are compiled against the current definitions and checked once, like the
+// body of a definition; any other symbol may change the definitions, so it's interpreted on its own and the code after it is compiled once it ran.
+namespace TopLevel
+{
+	// Interprets a program as if symbol by symbol, skipping whitespace if the interpreter ignores it
+	void Interpret(Emmental& interpreter, const char* program, std::size_t size);
+	// Interprets the longest prefix of a program that has no observable effect, and returns its length.
+	// The prefix behaves the same on every run, so its resulting state can be reused by runs with any input.
+	std::size_t InterpretPrefix(Emmental& interpreter, const char* program, std::size_t size);
+}
\ No newline at end of file
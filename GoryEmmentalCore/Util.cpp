@@ -51,7 +51,11 @@ std::string Util::GetPrintable(SymbolT symbol)
 	case 31: return "US";
 	case 32: return "SP";
 	case 127: return "DEL";
-	default: return std::string(1, symbol);
+	default: 
+		if (symbol > 255)
+			return "WIDE";
+
+		return std::string(1, (char)symbol);
 	}
 }
 
@@ -0,0 +1,353 @@
+#include "Superoptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <unordered_set>
+#include "InterpretedDefinition.h"
+#include "NativeDefinition.h"
+#include "CycleDetector.h"
+
+bool Superoptimizer::State::operator==(const State& other) const
+{
+	return Stack == other.Stack && Queue == other.Queue && Output == other.Output && InputPosition == other.InputPosition;
+}
+
+Superoptimizer::Superoptimizer(const Options& options)
+	: Settings(options), Random(options.Seed), Engine(Input, Output, Errors)
+{
+	// A fresh interpreter only has the native definitions
+	Natives = Engine.CopyDefinitions();
+
+	for (auto& native : Natives)
+	{
+		const StackEffect* effect = native.second->GetStackEffect();
+		if (effect)
+			Primitives.push_back({ native.first, native.second.get(), *effect });
+	}
+}
+
+bool Superoptimizer::Flatten(const EmmentalDefinition* definition, ProgramT& natives)
+{
+	if (!definition || !definition->GetStackEffect())
+		return false;
+
+	const NativeDefinition* native = definition->AsNative();
+	if (native)
+	{
+		natives.push_back(native->GetSymbol());
+		return true;
+	}
+
+	// A static effect means every captured definition has one too, so the recursion ends at natives
+	const InterpretedDefinition* interpreted = definition->AsInterpreted();
+	for (std::size_t i = 0; i < interpreted->GetProgramSize(); i++)
+	{
+		if (!Flatten(interpreted->GetCapture(interpreted->GetProgramSymbol(i)), natives))
+			return false;
+	}
+
+	return true;
+}
+
+Superoptimizer::Result Superoptimizer::Optimize(const std::shared_ptr<EmmentalDefinition>& definition)
+{
+	Result result;
+	result.Outcome = Status::Unsupported;
+
+	if (!Flatten(definition.get(), result.Original))
+		return result;
+
+	// Nothing is shorter than a single native, or no native at all
+	if (result.Original.size() <= 1)
+	{
+		result.Outcome = Status::NotFound;
+		return result;
+	}
+
+	result.Outcome = Search(definition, result.Original, result);
+	return result;
+}
+
+// Mixes what the static effect of a program tells about it into its hash
+static std::uint64_t MixEffect(std::uint64_t hash, const StackEffect& effect, std::size_t reads, std::size_t writes)
+{
+	hash = CycleDetector::Mix(hash, (std::uint64_t)effect.StackRequired);
+	hash = CycleDetector::Mix(hash, (std::uint64_t)effect.StackGrowth);
+	hash = CycleDetector::Mix(hash, (std::uint64_t)effect.StackDelta);
+	hash = CycleDetector::Mix(hash, (std::uint64_t)effect.QueueRequired);
+	hash = CycleDetector::Mix(hash, (std::uint64_t)effect.QueueGrowth);
+	hash = CycleDetector::Mix(hash, (std::uint64_t)effect.QueueDelta);
+	hash = CycleDetector::Mix(hash, reads);
+	return CycleDetector::Mix(hash, writes);
+}
+
+Superoptimizer::Status Superoptimizer::Search(const std::shared_ptr<EmmentalDefinition>& definition, const ProgramT& original, Result& result)
+{
+	const StackEffect& target = *definition->GetStackEffect();
+	std::size_t targetReads = std::count(original.begin(), original.end(), ',');
+	std::size_t targetWrites = std::count(original.begin(), original.end(), '.');
+	std::size_t maxLength = std::min(Settings.MaxLength, original.size() - 1);
+
+	std::vector<State> tests;
+	std::uint64_t expected = 0;
+	std::uint64_t unchanged = 0;
+
+	for (std::size_t i = 0; i < Settings.TestStates; i++)
+	{
+		tests.push_back(GenerateState(target, targetReads));
+		Load(tests.back());
+		unchanged = Hash(unchanged, tests.back());
+		Engine.Execute(definition.get(), 0, 0);
+		expected = Hash(expected, tests.back());
+	}
+
+	// Programs are told apart by their effect and the states they leave, the first program of each kind found is the shortest one
+	std::unordered_set<std::uint64_t> seen = { MixEffect(unchanged, StackEffect(), 0, 0) };
+	std::vector<Candidate> level(1, { {}, StackEffect(), 0, 0 });
+
+	for (std::size_t length = 1; length <= maxLength; length++)
+	{
+		std::ptrdiff_t remaining = (std::ptrdiff_t)(maxLength - length);
+		std::vector<Candidate> next;
+
+		for (const Candidate& candidate : level)
+		{
+			std::vector<State> states;
+			for (const State& test : tests)
+				states.push_back(Execute(candidate.Program, test));
+
+			for (const Primitive& primitive : Primitives)
+			{
+				Candidate extended = { candidate.Program, candidate.Effect.Then(primitive.Effect),
+					candidate.Reads + (primitive.Symbol == ','), candidate.Writes + (primitive.Symbol == '.') };
+				const StackEffect& effect = extended.Effect;
+
+				// Requirements and growth never decrease as a program gets longer, and each native changes a size by at most one
+				if (effect.StackRequired > target.StackRequired || effect.QueueRequired > target.QueueRequired
+					|| effect.StackGrowth > target.StackGrowth || effect.QueueGrowth > target.QueueGrowth
+					|| extended.Reads > targetReads || extended.Writes > targetWrites
+					|| std::abs(effect.StackDelta - target.StackDelta) > remaining || std::abs(effect.QueueDelta - target.QueueDelta) > remaining
+					|| (std::ptrdiff_t)(targetReads - extended.Reads + targetWrites - extended.Writes) > remaining)
+				{
+					continue;
+				}
+
+				std::uint64_t hash = 0;
+				for (const State& state : states)
+				{
+					Load(state);
+					Engine.Execute(primitive.Definition, primitive.Symbol, 0);
+					hash = Hash(hash, state);
+				}
+
+				extended.Program.push_back(primitive.Symbol);
+
+				// Running out of stack or queue, or filling them, happens in the same states as with the definition
+				bool sameEffect = effect.StackRequired == target.StackRequired && effect.StackDelta == target.StackDelta
+					&& effect.QueueRequired == target.QueueRequired && effect.QueueDelta == target.QueueDelta
+					&& extended.Reads == targetReads && extended.Writes == targetWrites;
+
+				if (sameEffect && hash == expected)
+				{
+					std::shared_ptr<EmmentalDefinition> replacement = Engine.CreateDefinition(extended.Program, Natives);
+					result.VerifiedStates = Verify(definition.get(), replacement.get(), target, targetReads);
+
+					if (result.VerifiedStates != 0)
+					{
+						result.Replacement = extended.Program;
+						result.OriginalNanoseconds = Measure(definition.get(), tests[0]);
+						result.ReplacementNanoseconds = Measure(replacement.get(), tests[0]);
+						return Status::Improved;
+					}
+				}
+
+				if (remaining > 0 && seen.insert(MixEffect(hash, effect, extended.Reads, extended.Writes)).second)
+					next.push_back(std::move(extended));
+			}
+		}
+
+		if (next.size() > Settings.MaxPrograms)
+			return Status::GaveUp;
+
+		level = std::move(next);
+	}
+
+	return Status::NotFound;
+}
+
+std::uint64_t Superoptimizer::Verify(EmmentalDefinition* definition, EmmentalDefinition* replacement, const StackEffect& effect, std::size_t reads)
+{
+	std::uint64_t count = 0;
+	std::size_t cells = (std::size_t)(effect.StackRequired + effect.QueueRequired);
+
+	// With few narrow cells, every combination of their values is tried
+	if (Engine.GetCellWidth() == 8 && cells <= 2 && reads == 0)
+	{
+		for (std::uint64_t values = 0; values < (1ULL << (8 * cells)); values++)
+		{
+			// The required cells are the top of the stack and the front of the queue
+			State state = GenerateState(effect, reads);
+			std::size_t stackBase = state.Stack.size() - (std::size_t)effect.StackRequired;
+			for (std::size_t i = 0; i < (std::size_t)effect.StackRequired; i++)
+				state.Stack[stackBase + i] = (values >> (8 * i)) & 0xFF;
+			for (std::size_t i = 0; i < (std::size_t)effect.QueueRequired; i++)
+				state.Queue[i] = (values >> (8 * (effect.StackRequired + i))) & 0xFF;
+
+			if (!(Execute(definition, state) == Execute(replacement, state)))
+				return 0;
+
+			count++;
+		}
+	}
+
+	for (std::size_t i = 0; i < Settings.VerifyStates; i++)
+	{
+		State state = GenerateState(effect, reads);
+		if (!(Execute(definition, state) == Execute(replacement, state)))
+			return 0;
+
+		count++;
+	}
+
+	return count;
+}
+
+double Superoptimizer::Measure(EmmentalDefinition* definition, const State& state)
+{
+	const std::size_t Calls = 20000;
+	const std::size_t Rounds = 5;
+
+	// The fastest of several rounds, with and without the call, is the least disturbed by anything else
+	auto time = [&](bool call)
+	{
+		double best = std::numeric_limits<double>::max();
+
+		for (std::size_t round = 0; round < Rounds; round++)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			for (std::size_t i = 0; i < Calls; i++)
+			{
+				Load(state);
+				if (call)
+					Engine.Execute(definition, 0, 0);
+			}
+
+			best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		return best;
+	};
+
+	return std::max(0.0, time(true) - time(false)) / Calls;
+}
+
+Superoptimizer::State Superoptimizer::GenerateState(const StackEffect& effect, std::size_t reads)
+{
+	State state;
+	state.InputPosition = 0;
+
+	// Cells beyond the required ones tell apart programs that only agree on a stack or queue holding nothing else, like ^v and :
+	std::size_t stackSize = (std::size_t)effect.StackRequired + Random() % (ExtraCells + 1);
+	std::size_t queueSize = (std::size_t)effect.QueueRequired + Random() % (ExtraCells + 1);
+
+	for (std::size_t i = 0; i < stackSize; i++)
+		state.Stack.push_back(GenerateCell());
+	for (std::size_t i = 0; i < queueSize; i++)
+		state.Queue.push_back(GenerateCell());
+
+	// Input is read with operator>>, which skips whitespace, so it's made of other bytes to last for every read
+	for (std::size_t i = 0; i < reads; i++)
+		state.Input.push_back((char)(33 + Random() % (256 - 33)));
+
+	return state;
+}
+
+SymbolT Superoptimizer::GenerateCell()
+{
+	// Small numbers and the ends of the cell range catch most rewrites that only work for typical values
+	static const SymbolT Special[] = { 0, 1, 2, 9, 10, ';' };
+	unsigned int width = Engine.GetCellWidth();
+	SymbolT mask = width >= 64 ? ~(SymbolT)0 : ((SymbolT)1 << width) - 1;
+
+	switch (Random() % 4)
+	{
+	case 0: return Special[Random() % (sizeof(Special) / sizeof(Special[0]))];
+	case 1: return mask - Random() % 3;
+	default: return Random() & mask;
+	}
+}
+
+void Superoptimizer::Load(const State& state)
+{
+	Engine.ClearStack();
+	for (SymbolT item : state.Stack)
+		Engine.Push(item);
+
+	Engine.ClearQueue();
+	for (SymbolT item : state.Queue)
+		Engine.Enqueue(item);
+
+	if (!state.Input.empty())
+	{
+		Input.str(state.Input);
+		Input.clear();
+		Input.seekg(state.InputPosition);
+	}
+
+	Output.str("");
+}
+
+Superoptimizer::State Superoptimizer::Save(const State& before)
+{
+	State state;
+
+	const SymbolDeque& stack = Engine.GetStackStorage();
+	for (std::size_t i = 0; i < stack.Size(); i++)
+		state.Stack.push_back(stack.At(i));
+
+	const SymbolDeque& queue = Engine.GetQueueStorage();
+	for (std::size_t i = 0; i < queue.Size(); i++)
+		state.Queue.push_back(queue.At(i));
+
+	state.Input = before.Input;
+	state.Output = before.Output + Output.str();
+	state.InputPosition = before.Input.empty() ? 0 : (std::streamoff)Input.tellg();
+	return state;
+}
+
+Superoptimizer::State Superoptimizer::Execute(EmmentalDefinition* definition, const State& state)
+{
+	Load(state);
+	Engine.Execute(definition, 0, 0);
+	return Save(state);
+}
+
+Superoptimizer::State Superoptimizer::Execute(const ProgramT& program, const State& state)
+{
+	Load(state);
+
+	for (SymbolT symbol : program)
+		Engine.Execute(Natives.at(symbol).get(), symbol, 0);
+
+	return Save(state);
+}
+
+std::uint64_t Superoptimizer::Hash(std::uint64_t hash, const State& before)
+{
+	const SymbolDeque& stack = Engine.GetStackStorage();
+	hash = CycleDetector::Mix(hash, stack.Size());
+	for (std::size_t i = 0; i < stack.Size(); i++)
+		hash = CycleDetector::Mix(hash, stack.At(i));
+
+	const SymbolDeque& queue = Engine.GetQueueStorage();
+	hash = CycleDetector::Mix(hash, queue.Size());
+	for (std::size_t i = 0; i < queue.Size(); i++)
+		hash = CycleDetector::Mix(hash, queue.At(i));
+
+	for (char byte : before.Output + Output.str())
+		hash = CycleDetector::Mix(hash, (unsigned char)byte);
+
+	return CycleDetector::Mix(hash, before.Input.empty() ? 0 : (std::uint64_t)Input.tellg());
+}
\ No newline at end of file
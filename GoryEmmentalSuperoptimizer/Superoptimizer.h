@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Config.h"
+#include "Emmental.h"
+
+// Searches for the shortest program of natives equivalent to a definition that only executes natives with a static effect.
+// Programs are enumerated by length. A program is pruned once its static effect can't match the definition's anymore, or once it leaves
+// the same states as a shorter or earlier program on a fixed set of test states, as every program extending it has an equivalent then.
+// Programs that match the definition on the test states are verified by executing both as definitions of the engine on many more states.
+class Superoptimizer
+{
+public:
+	struct Options
+	{
+		// Longest program searched, in natives
+		std::size_t MaxLength = 6;
+		// States programs are compared on during the search, and while verifying a match
+		std::size_t TestStates = 32;
+		std::size_t VerifyStates = 10000;
+		// Most programs kept of one length before the search gives up
+		std::size_t MaxPrograms = 1000000;
+		std::uint64_t Seed = 1;
+	};
+
+	enum class Status
+	{
+		// A shorter equivalent program was found
+		Improved,
+		// No shorter equivalent program exists up to the maximum length
+		NotFound,
+		// The search kept too many programs, a shorter equivalent program may exist
+		GaveUp,
+		// The definition executes something other than natives with a static effect
+		Unsupported
+	};
+
+	struct Result
+	{
+		Status Outcome;
+		// Natives the definition executes, with the definitions it captures expanded
+		ProgramT Original;
+		ProgramT Replacement;
+		// States the replacement was verified on
+		std::uint64_t VerifiedStates = 0;
+		// Time of a call to the definition and to its replacement
+		double OriginalNanoseconds = 0;
+		double ReplacementNanoseconds = 0;
+	};
+
+	explicit Superoptimizer(const Options& options);
+
+	// Searches for a replacement of a definition, which must not be nullptr
+	Result Optimize(const std::shared_ptr<EmmentalDefinition>& definition);
+
+	// Appends the natives a definition executes, expanding the definitions it captures.
+	// Returns false unless it only executes natives with a static effect.
+	static bool Flatten(const EmmentalDefinition* definition, ProgramT& natives);
+
+private:
+	// Most cells generated beyond the ones a definition requires, on the stack and on the queue
+	static const std::size_t ExtraCells = 2;
+
+	struct State
+	{
+		std::vector<SymbolT> Stack;
+		std::vector<SymbolT> Queue;
+		std::string Input;
+		std::string Output;
+		// Input read so far
+		std::streamoff InputPosition;
+
+		bool operator==(const State& other) const;
+	};
+
+	// A program kept by the search to be extended. Its states are recomputed when it's extended, instead of being kept for every program.
+	struct Candidate
+	{
+		ProgramT Program;
+		StackEffect Effect;
+		std::size_t Reads;
+		std::size_t Writes;
+	};
+
+	// A native the search builds programs of
+	struct Primitive
+	{
+		SymbolT Symbol;
+		EmmentalDefinition* Definition;
+		StackEffect Effect;
+	};
+
+	Options Settings;
+	std::mt19937_64 Random;
+	std::istringstream Input;
+	std::ostringstream Output;
+	std::ostringstream Errors;
+	// Executes everything, with the native definitions only
+	Emmental Engine;
+	SymbolMapT Natives;
+	std::vector<Primitive> Primitives;
+
+	State GenerateState(const StackEffect& effect, std::size_t reads);
+	SymbolT GenerateCell();
+	void Load(const State& state);
+	State Save(const State& before);
+	// Executes a definition on a copy of a state and returns the resulting state
+	State Execute(EmmentalDefinition* definition, const State& state);
+	// Executes a program of natives on a copy of a state and returns the resulting state
+	State Execute(const ProgramT& program, const State& state);
+	// Hashes the state the engine is in, given the state it was loaded with
+	std::uint64_t Hash(std::uint64_t hash, const State& before);
+
+	// Searches for the shortest program that leaves every test state like the definition does
+	Status Search(const std::shared_ptr<EmmentalDefinition>& definition, const ProgramT& original, Result& result);
+	// Compares a program with the definition on the verification states, and returns the number of states they agreed on, 0 if any differed
+	std::uint64_t Verify(EmmentalDefinition* definition, EmmentalDefinition* replacement, const StackEffect& effect, std::size_t reads);
+	// Measures the time of a call to a definition on a state, without the time of loading the state
+	double Measure(EmmentalDefinition* definition, const State& state);
+};
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Emmental.h"
+#include "InterpretedDefinition.h"
+#include "TopLevel.h"
+#include "Util.h"
+#include "Globals.h"
+#include "EmmentalException.h"
+#include "Superoptimizer.h"
+#include "tclap\CmdLine.h"
+
+// Reads a whole file into memory. Returns false and prints an error if it can't be read.
+static bool ReadFile(const std::string& filename, std::vector<char>& contents)
+{
+#if _WIN32 && _UNICODE
+	// Non-Standard MSVC extension, allows usage of std::wstring for Unicode filenames
+	std::ifstream file(Util::ToUtf16(filename), std::ios_base::binary | std::ios_base::in);
+#else // _WIN32 && _UNICODE
+	std::ifstream file(filename, std::ios_base::binary | std::ios_base::in);
+#endif // _WIN32 && _UNICODE
+
+	if (!file)
+	{
+		std::cerr << "Error: Unable to read file " << filename << std::endl;
+		return false;
+	}
+
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// Writes the top-level code that supplants a symbol with a program of natives
+static void DescribeSupplant(SymbolT symbol, const ProgramT& program, std::ostream& output)
+{
+	output << ";";
+	for (SymbolT native : program)
+		output << "#" << native;
+
+	output << "#" << symbol << "!";
+}
+
+// Searches for a replacement of a definition and prints the outcome. Returns true if it found one.
+static bool OptimizeDefinition(Superoptimizer& optimizer, SymbolT symbol, const std::shared_ptr<EmmentalDefinition>& definition, std::size_t maxLength)
+{
+	Util::DescribeDefinition(symbol, definition.get(), false, std::cout);
+	std::cout << std::endl;
+
+	if (!definition)
+		return false;
+
+	Superoptimizer::Result result = optimizer.Optimize(definition);
+
+	if (result.Outcome == Superoptimizer::Status::Unsupported)
+	{
+		std::cout << "  Skipped: It executes '?', '!', an undefined symbol, or a definition too large to be inlined." << std::endl;
+		return false;
+	}
+
+	std::cout << "  Executes " << result.Original.size() << " natives: ";
+	Util::DescribeProgram(result.Original, std::cout);
+	std::cout << std::endl;
+
+	if (result.Outcome == Superoptimizer::Status::NotFound)
+	{
+		std::cout << "  No shorter equivalent program of up to " << maxLength << " natives." << std::endl;
+		return false;
+	}
+
+	if (result.Outcome == Superoptimizer::Status::GaveUp)
+	{
+		std::cout << "  Gave up, too many distinct programs. Try a lower --max-length, or a higher --max-programs." << std::endl;
+		return false;
+	}
+
+	Util::Colorize(Util::ConsoleColor::BrightGreen, std::cout);
+	std::cout << "  Replacement: ";
+	Util::Colorize(Util::ConsoleColor::Default, std::cout);
+	Util::DescribeProgram(result.Replacement, std::cout);
+	std::cout << " (" << result.Replacement.size() << (result.Replacement.size() == 1 ? " native" : " natives") << ", verified on " << result.VerifiedStates << " states)" << std::endl;
+
+	std::cout << "  Speed: " << result.OriginalNanoseconds << " ns -> " << result.ReplacementNanoseconds << " ns per call";
+	if (result.ReplacementNanoseconds > 0)
+		std::cout << " (" << result.OriginalNanoseconds / result.ReplacementNanoseconds << "x)";
+	std::cout << std::endl;
+
+	// Symbols are only natives where nothing redefined them, usually at the start of a library
+	std::cout << "  Rewrite where its symbols are natives: ";
+	DescribeSupplant(symbol, result.Replacement, std::cout);
+	std::cout << std::endl;
+	return true;
+}
+
+int Start(std::vector<std::string>& args)
+{
+	Globals::Initialize();
+
+	try
+	{
+		TCLAP::CmdLine cmd("Searches for shorter programs of natives equivalent to the definitions left by an Emmental program.", '=', "1.0.0");
+
+		TCLAP::SwitchArg colorArg("c", "color",
+			"Disables Virtual Console coloring for systems that support it, or forcefully enables it for systems that don't.",
+			cmd, Globals::UseVirtualConsole);
+		TCLAP::SwitchArg ignoreWhitespaceArg("w", "nowhitespace", "Ignores whitespace characters in the Emmental program.", cmd, Globals::IgnoreWhitespace);
+
+		std::vector<unsigned int> cellWidths = { 8, 16, 32, 64 };
+		TCLAP::ValuesConstraint<unsigned int> cellWidthConstraint(cellWidths);
+		TCLAP::ValueArg<unsigned int> cellWidthArg("b", "bits", "Width of stack and queue cells in bits, as given to the interpreter.",
+			false, Globals::CellWidth, &cellWidthConstraint, cmd);
+		TCLAP::MultiArg<std::uint64_t> symbolArg("s", "symbol",
+			"Number of a symbol whose definition is optimized. Defaults to every symbol with an interpreted definition.", false, "symbol", cmd);
+
+		Superoptimizer::Options defaults;
+		TCLAP::ValueArg<std::size_t> maxLengthArg("", "max-length", "Longest program searched, in natives.", false, defaults.MaxLength, "natives", cmd);
+		TCLAP::ValueArg<std::size_t> testsArg("", "tests", "Number of states programs are compared on during the search.",
+			false, defaults.TestStates, "count", cmd);
+		TCLAP::ValueArg<std::size_t> verifyArg("", "verify", "Number of random states a replacement is verified on, besides every state of up to two 8-bit cells.",
+			false, defaults.VerifyStates, "count", cmd);
+		TCLAP::ValueArg<std::size_t> maxProgramsArg("", "max-programs", "Most programs of one length kept by the search before it gives up.",
+			false, defaults.MaxPrograms, "count", cmd);
+		TCLAP::ValueArg<std::uint64_t> seedArg("", "seed", "Seed of the generated states.", false, defaults.Seed, "number", cmd);
+		TCLAP::UnlabeledValueArg<std::string> inputFileArg("Input",
+			"The Emmental code file that defines the symbols, executed without input and with its output discarded.", true, "", "file", cmd);
+
+		cmd.parse(args);
+		Globals::UseVirtualConsole = colorArg.getValue();
+		Globals::IgnoreWhitespace = ignoreWhitespaceArg.getValue();
+		Globals::CellWidth = cellWidthArg.getValue();
+
+		Superoptimizer::Options options;
+		options.MaxLength = maxLengthArg.getValue();
+		options.TestStates = testsArg.getValue();
+		options.VerifyStates = verifyArg.getValue();
+		options.MaxPrograms = maxProgramsArg.getValue();
+		options.Seed = seedArg.getValue();
+
+		if (options.TestStates == 0)
+		{
+			std::cerr << "Error: Programs must be compared on at least one state." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::vector<char> program;
+		if (!ReadFile(inputFileArg.getValue(), program))
+			return EXIT_FAILURE;
+
+		std::istringstream input;
+		std::ostringstream output;
+		Emmental library(input, output, std::cerr);
+
+		try
+		{
+			TopLevel::Interpret(library, program.data(), program.size());
+		}
+		catch (const EmmentalException&)
+		{
+			return EXIT_FAILURE;
+		}
+
+		std::vector<SymbolT> symbols(symbolArg.getValue().begin(), symbolArg.getValue().end());
+		if (symbols.empty())
+		{
+			for (auto& definition : library.CopyDefinitions())
+			{
+				if (definition.second->AsInterpreted())
+					symbols.push_back(definition.first);
+			}
+		}
+
+		Superoptimizer optimizer(options);
+		std::size_t improved = 0;
+
+		for (SymbolT symbol : symbols)
+		{
+			if (OptimizeDefinition(optimizer, symbol, library.GetDefinition(symbol), options.MaxLength))
+				improved++;
+
+			std::cout << std::endl;
+		}
+
+		std::cout << improved << " of " << symbols.size() << " definitions have a shorter equivalent." << std::endl;
+		return EXIT_SUCCESS;
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "Error: " << e.error() << " for argument " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
+
+#if _WIN32 && _UNICODE
+int wmain(int argc, wchar_t** argv)
+{
+	// Convert from UTF16 to UTF8
+	std::vector<std::string> args;
+	for (int i = 0; i < argc; i++)
+	{
+		args.emplace_back(Util::ToUtf8(argv[i]));
+	}
+
+	return Start(args);
+}
+#else // _WIN32 && _UNICODE
+int main(int argc, char** argv)
+{
+	// Put arguments in a vector
+	std::vector<std::string> args;
+	for (int i = 0; i < argc; i++)
+	{
+		args.emplace_back(argv[i]);
+	}
+
+	return Start(args);
+}
+#endif // _WIN32 && _UNICODE
\ No newline at end of file